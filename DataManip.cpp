@@ -15,16 +15,15 @@
 #include "DataManip.h"
 
 std::string DataManip::dataToString(int data) {
-    return std::to_string(data);
+    char buffer[FORMAT_BUFFER_SIZE];
+    size_t length = formatInt(data, buffer, sizeof(buffer));
+    return std::string(buffer, length);
 }
 
 std::string DataManip::dataToString(float data, int numDecimals) {
-    int whole = floor(data);
-    int large1 = round(data * pow(10, numDecimals));
-    int large2 = round(whole * pow(10, numDecimals));
-    int fraction = large1 - large2;
-    
-    return std::to_string(whole) + "." + std::to_string(fraction);
+    char buffer[FORMAT_BUFFER_SIZE];
+    size_t length = formatFixed(data, numDecimals, buffer, sizeof(buffer));
+    return std::string(buffer, length);
 }
 
 std::string DataManip::dataToString(bool data) {
@@ -40,3 +39,111 @@ std::string DataManip::dataToString(bool data) {
 uint16_t DataManip::roundInt(float r) {
     return r + 0.5;
 }
+
+
+static const uint64_t powersOfTen[DataManip::MAX_DECIMALS + 1] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+// Writes data as decimal text and a terminating null into buffer, without allocating.
+// Returns the length of the text, or 0 with an empty buffer if it does not fit.
+size_t DataManip::formatInt(long data, char *buffer, size_t size) {
+    char digits[FORMAT_BUFFER_SIZE];
+    size_t length = 0;
+    
+    // negate in unsigned arithmetic so the most negative value does not overflow
+    uint64_t magnitude = (data < 0) ? (0 - (uint64_t)data) : (uint64_t)data;
+    if (data < 0) {
+        digits[length++] = '-';
+    }
+    length += formatDigits(magnitude, digits + length);
+    
+    if (length >= size) {
+        if (size > 0) {
+            buffer[0] = '\0';
+        }
+        return 0;
+    }
+    
+    memcpy(buffer, digits, length);
+    buffer[length] = '\0';
+    
+    return length;
+}
+
+// Writes data as fixed point text with numDecimals places (0 to MAX_DECIMALS) and a
+// terminating null into buffer, without allocating. The last place is rounded half
+// away from zero, and a value which rounds to zero has no minus sign. Values of 1e20 and
+// above, and infinity, are written in %g form. Returns the length of the text, or 0 with
+// an empty buffer if it does not fit.
+size_t DataManip::formatFixed(double data, int numDecimals, char *buffer, size_t size) {
+    char text[FORMAT_BUFFER_SIZE];
+    size_t length = 0;
+    
+    if (numDecimals < 0) {
+        numDecimals = 0;
+    }
+    else if (numDecimals > MAX_DECIMALS) {
+        numDecimals = MAX_DECIMALS;
+    }
+    
+    double scaled = fabs(data) * powersOfTen[numDecimals] + 0.5;
+    
+    if (isnan(data)) {
+        length = snprintf(text, sizeof(text), "nan");
+    }
+    else if (scaled >= 1e19) {
+        // beyond 64 bits, including infinity, where the C library does the work. Fixed point
+        // text for 1e20 and above may not fit in the buffer, so those values use %g form.
+        bool fixed = fabs(data) < 1e20;
+        length = snprintf(text, sizeof(text), fixed ? "%.*f" : "%.*g", fixed ? numDecimals : 6, data);
+    }
+    else {
+        uint64_t value = (uint64_t)scaled;
+        
+        if ((data < 0) && (value != 0)) {
+            text[length++] = '-';
+        }
+        
+        length += formatDigits(value / powersOfTen[numDecimals], text + length);
+        
+        if (numDecimals > 0) {
+            text[length++] = '.';
+            
+            // the fraction keeps its leading zeros, so 1.05 does not become 1.5
+            uint64_t fraction = value % powersOfTen[numDecimals];
+            for (int place = numDecimals - 1; place >= 0; place--) {
+                text[length++] = '0' + (fraction / powersOfTen[place]) % 10;
+            }
+        }
+    }
+    
+    if ((length == 0) || (length >= size) || (length >= sizeof(text))) {
+        if (size > 0) {
+            buffer[0] = '\0';
+        }
+        return 0;
+    }
+    
+    memcpy(buffer, text, length);
+    buffer[length] = '\0';
+    
+    return length;
+}
+
+// Writes the decimal digits of value, most significant first, returning how many
+size_t DataManip::formatDigits(uint64_t value, char *buffer) {
+    char reversed[20];
+    size_t count = 0;
+    
+    do {
+        reversed[count++] = '0' + (value % 10);
+        value /= 10;
+    } while (value);
+    
+    for (size_t i = 0; i < count; i++) {
+        buffer[i] = reversed[count - 1 - i];
+    }
+    
+    return count;
+}
@@ -17,6 +17,9 @@
 
 #include <string>
 #include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
 
 class DataManip {
 
@@ -27,10 +30,20 @@ public:
     static std::string dataToString(bool data);
     static uint16_t roundInt(float r);
     
+    static size_t formatInt(long data, char *buffer, size_t size);
+    static size_t formatFixed(double data, int numDecimals, char *buffer, size_t size);
+    
+    // holds formatFixed text: below 1e20 at MAX_DECIMALS places takes at most 31 characters
+    // and a null, and larger values are written in %g form
+    static const size_t FORMAT_BUFFER_SIZE = 32;
+    static const int MAX_DECIMALS = 9;
+    
 protected:
     
 private:
     
+    static size_t formatDigits(uint64_t value, char *buffer);
+    
 };
 
 #endif /* __DataManip__ */
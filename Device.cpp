@@ -20,6 +20,10 @@ Device::Device() {
     
 }
 
+Device::~Device() {
+    
+}
+
 std::string Device::getVersion() {
     return name + " " + version;
 }
@@ -67,4 +71,14 @@ std::string Device::getValueByName(std::string name) {
     return "none";
 }
 
-
+// Numeric form of the value at index, false when there is no valid value. Devices
+// which hold their values as numbers override this to skip the string conversion.
+bool Device::getNumberAtIndex(int index, double &value) {
+    
+    std::string text = this->getValueAtIndex(index);
+    
+    char *end;
+    value = strtod(text.c_str(), &end);
+    
+    return (end != text.c_str()) && (*end == '\0');
+}
@@ -33,6 +33,7 @@ class Device {
     
 public:
     Device();
+    virtual ~Device();
     
     virtual std::string getVersion();
     virtual std::string getDeviceName();
@@ -44,6 +45,7 @@ public:
     virtual bool isActive();
     virtual std::string getValueByName(std::string name);
     virtual std::string getValueAtIndex(int index) =0;
+    virtual bool getNumberAtIndex(int index, double &value);
     
 protected:
     
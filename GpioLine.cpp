@@ -0,0 +1,186 @@
+/**
+ * \file GpioLine.cpp
+ *
+ *  Copyright (c) 2026 Agilatech. All rights reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "GpioLine.h"
+
+GpioLine::GpioLine() {
+}
+
+GpioLine::~GpioLine() {
+    release();
+}
+
+/**
+ * Request edge events on a line, releasing any line already held
+ * @param chip The GPIO character device, for example /dev/gpiochip0
+ * @param offset The line number within the chip
+ * @param fallingEdge true to report falling edges (an active low interrupt), false for rising edges
+ * @return 0 on success, otherwise an errno value
+ */
+int GpioLine::requestEvents(const std::string &chip, uint32_t offset, bool fallingEdge) {
+    release();
+    
+    int chipFd = ::open(chip.c_str(), O_RDONLY);
+    if (chipFd < 0) {
+        int error = errno;
+        std::cerr << "GpioLine: Failed to open " << chip << std::endl;
+        return error;
+    }
+    
+    struct gpioevent_request request;
+    memset(&request, 0, sizeof(request));
+    request.lineoffset = offset;
+    request.handleflags = GPIOHANDLE_REQUEST_INPUT;
+    request.eventflags = fallingEdge ? GPIOEVENT_REQUEST_FALLING_EDGE : GPIOEVENT_REQUEST_RISING_EDGE;
+    strncpy(request.consumer_label, "vl6180", sizeof(request.consumer_label) - 1);
+    
+    int result = ioctl(chipFd, GPIO_GET_LINEEVENT_IOCTL, &request);
+    int error = errno;
+    ::close(chipFd);
+    
+    if (result < 0) {
+        std::cerr << "GpioLine: Failed to request events on line " << offset << std::endl;
+        return error;
+    }
+    
+    // reads are only made once poll reports an event, or to drain stale ones
+    fcntl(request.fd, F_SETFL, fcntl(request.fd, F_GETFL) | O_NONBLOCK);
+    this->fd = request.fd;
+    
+    return 0;
+}
+
+/**
+ * Request a line as an output, releasing any line already held
+ * @param chip The GPIO character device, for example /dev/gpiochip0
+ * @param offset The line number within the chip
+ * @param value The level the line is driven to at once
+ * @return 0 on success, otherwise an errno value
+ */
+int GpioLine::requestOutput(const std::string &chip, uint32_t offset, bool value) {
+    release();
+    
+    int chipFd = ::open(chip.c_str(), O_RDONLY);
+    if (chipFd < 0) {
+        int error = errno;
+        std::cerr << "GpioLine: Failed to open " << chip << std::endl;
+        return error;
+    }
+    
+    struct gpiohandle_request request;
+    memset(&request, 0, sizeof(request));
+    request.lineoffsets[0] = offset;
+    request.lines = 1;
+    request.flags = GPIOHANDLE_REQUEST_OUTPUT;
+    request.default_values[0] = value ? 1 : 0;
+    strncpy(request.consumer_label, "vl6180", sizeof(request.consumer_label) - 1);
+    
+    int result = ioctl(chipFd, GPIO_GET_LINEHANDLE_IOCTL, &request);
+    int error = errno;
+    ::close(chipFd);
+    
+    if (result < 0) {
+        std::cerr << "GpioLine: Failed to request output on line " << offset << std::endl;
+        return error;
+    }
+    
+    this->fd = request.fd;
+    
+    return 0;
+}
+
+/**
+ * Drive a line requested as an output
+ * @param value The level to drive the line to
+ * @return 0 on success, otherwise an errno value
+ */
+int GpioLine::setValue(bool value) {
+    if (this->fd < 0) {
+        return EBADF;
+    }
+    
+    struct gpiohandle_data data;
+    memset(&data, 0, sizeof(data));
+    data.values[0] = value ? 1 : 0;
+    
+    if (ioctl(this->fd, GPIOHANDLE_SET_LINE_VALUES_IOCTL, &data) < 0) {
+        return errno;
+    }
+    
+    return 0;
+}
+
+bool GpioLine::isOpen() {
+    return this->fd >= 0;
+}
+
+/**
+ * @return the event file descriptor, readable when an edge has occurred, or -1 if no line is held
+ */
+int GpioLine::getFd() {
+    return this->fd;
+}
+
+/**
+ * Block until the next edge or until the timeout passes, consuming the edge
+ * @param timeoutUs the longest time to wait
+ * @return 1 if an edge occurred, 0 on timeout, or a negative errno value
+ */
+int GpioLine::wait(uint32_t timeoutUs) {
+    if (this->fd < 0) {
+        return -EBADF;
+    }
+    
+    struct pollfd events;
+    events.fd = this->fd;
+    events.events = POLLIN | POLLPRI;
+    events.revents = 0;
+    
+    // round up so a short timeout still waits
+    int result = poll(&events, 1, (timeoutUs + 999) / 1000);
+    if (result < 0) {
+        return -errno;
+    }
+    if (result == 0) {
+        return 0;
+    }
+    
+    struct gpioevent_data event;
+    if (::read(this->fd, &event, sizeof(event)) != sizeof(event)) {
+        return -errno;
+    }
+    
+    return 1;
+}
+
+/**
+ * Discard any edges which have already occurred
+ */
+void GpioLine::clear() {
+    if (this->fd < 0) {
+        return;
+    }
+    
+    struct gpioevent_data event;
+    while (::read(this->fd, &event, sizeof(event)) == sizeof(event));
+}
+
+/**
+ * Give the line back to the kernel
+ */
+void GpioLine::release() {
+    if (this->fd >= 0) {
+        ::close(this->fd);
+        this->fd = -1;
+    }
+}
@@ -0,0 +1,54 @@
+/**
+ * \file GpioLine.h
+ *
+ *  Copyright (c) 2026 Agilatech. All rights reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __GpioLine__
+#define __GpioLine__
+
+#include <iostream>
+#include <string>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+
+/**
+ * @class GpioLine
+ * @brief One line of a Linux GPIO character device (/dev/gpiochipN), requested for edge events or as an output
+ *
+ * The event file descriptor is exposed so the line can be added to an existing poll or epoll set,
+ * or wait() can be used to block until the next edge. An output line holds its value until it is
+ * released.
+ */
+class GpioLine {
+    
+public:
+    GpioLine();
+    ~GpioLine();
+    
+    int requestEvents(const std::string &chip, uint32_t offset, bool fallingEdge = true);
+    int requestOutput(const std::string &chip, uint32_t offset, bool value);
+    int setValue(bool value);
+    bool isOpen();
+    int getFd();
+    int wait(uint32_t timeoutUs);
+    void clear();
+    void release();
+    
+protected:
+    int fd = -1;
+};
+
+#endif /* __GpioLine__ */
@@ -0,0 +1,131 @@
+/**
+ * \file I2CBus.cpp
+ *
+ *  Copyright (c) 2026 Agilatech. All rights reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "I2CBus.h"
+
+namespace i2cbus {
+    
+    std::mutex I2CBus::registryLock;
+    std::map<std::string, std::weak_ptr<I2CBus> > I2CBus::registry;
+    
+    /**
+     * Get the shared bus for a dev file, opening it if no device is currently using it. The bus is
+     * closed when the last device holding it lets go.
+     * @param devfile The /dev file. Usually something like /dev/i2c-1
+     * @return the bus, or an empty pointer if the dev file could not be opened
+     */
+    std::shared_ptr<I2CBus> I2CBus::acquire(const std::string &devfile) {
+        std::lock_guard<std::mutex> guard(registryLock);
+        
+        std::shared_ptr<I2CBus> bus = registry[devfile].lock();
+        if (bus) {
+            return bus;
+        }
+        
+        bus.reset(new I2CBus(devfile));
+        if (bus->file < 0) {
+            registry.erase(devfile);
+            return std::shared_ptr<I2CBus>();
+        }
+        
+        registry[devfile] = bus;
+        return bus;
+    }
+    
+    /**
+     * Opens the dev file. Only called through acquire().
+     * @param devfile The /dev file. Usually something like /dev/i2c-1
+     */
+    I2CBus::I2CBus(const std::string &devfile) {
+        this->devfile = devfile;
+        
+        if ((this->file = ::open(devfile.c_str(), O_RDWR)) < 0) {
+            std::cerr << "I2CBus: Failed to open the bus " << devfile << std::endl;
+            return;
+        }
+        
+        this->executor.reset(new I2CExecutor());
+    }
+    
+    /**
+     * Finishes any queued operations, then closes the dev file once no device holds the bus
+     */
+    I2CBus::~I2CBus() {
+        this->executor.reset();
+        
+        if (this->file >= 0) {
+            ::close(this->file);
+        }
+    }
+    
+    /**
+     * @return the dev file this bus was opened on
+     */
+    std::string I2CBus::getDevfile() const {
+        return this->devfile;
+    }
+    
+    /**
+     * Submit a group of messages as one combined transaction. Each message carries its own slave
+     * address. The transfer runs on the executor thread, and the caller waits for it to complete.
+     * @param messages the messages to send, each beginning with a (repeated) start
+     * @param count the number of messages, no more than I2C_RDWR_IOCTL_MAX_MSGS
+     * @return 0 on success, otherwise the errno reported by the adapter
+     */
+    int I2CBus::transfer(struct i2c_msg *messages, uint32_t count) {
+        // operations already on the executor thread go straight to the bus
+        if (this->executor->isExecutorThread()) {
+            return this->transferNow(messages, count);
+        }
+        
+        return this->executor->submit([this, messages, count]() {
+            return this->transferNow(messages, count);
+        }).get();
+    }
+    
+    /**
+     * Queue an operation to run on the bus's executor thread without waiting for it. Transfers made
+     * by the operation go directly to the bus, so a sequence of transfers submitted as one operation
+     * cannot be interleaved with any other device's.
+     * @param operation the work to run, returning 0 or an errno value
+     * @return a future which receives the operation's result
+     */
+    std::future<int> I2CBus::submit(I2CExecutor::Operation operation) {
+        return this->executor->submit(operation);
+    }
+    
+    /**
+     * Queue an operation to run on the bus's executor thread without waiting for it.
+     * @param operation the work to run, returning 0 or an errno value
+     * @param completion called on the executor thread with the operation's result
+     */
+    void I2CBus::submit(I2CExecutor::Operation operation, I2CExecutor::Completion completion) {
+        this->executor->submit(operation, completion);
+    }
+    
+    int I2CBus::transferNow(struct i2c_msg *messages, uint32_t count) {
+        struct i2c_rdwr_ioctl_data transaction;
+        transaction.msgs = messages;
+        transaction.nmsgs = count;
+        
+        int sent = ioctl(this->file, I2C_RDWR, &transaction);
+        if (sent < 0) {
+            return errno;
+        }
+        if (sent != (int)count) {
+            return EIO;
+        }
+        return 0;
+    }
+    
+} /* namespace i2cbus */
@@ -0,0 +1,66 @@
+/**
+ * \file I2CBus.h
+ *
+ *  Copyright (c) 2026 Agilatech. All rights reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __I2CBus__
+#define __I2CBus__
+
+#include <iostream>
+#include <string>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/ioctl.h>
+#include "I2CTransport.h"
+#include "I2CExecutor.h"
+
+namespace i2cbus {
+    
+    /**
+     * @class I2CBus
+     * @brief One open /dev/i2c-N file shared by every device on that bus
+     *
+     * Buses are obtained through acquire(), which returns the existing bus for a dev file if one is
+     * already open. Devices are addressed per message with I2C_RDWR rather than binding the file to a
+     * single slave. All access to the file happens on the bus's own executor thread, so transfers from
+     * every device on the bus run strictly in submission order.
+     */
+    class I2CBus : public I2CTransport {
+        
+    public:
+        static std::shared_ptr<I2CBus> acquire(const std::string &devfile);
+        ~I2CBus();
+        
+        std::string getDevfile() const;
+        virtual int transfer(struct i2c_msg *messages, uint32_t count);
+        std::future<int> submit(I2CExecutor::Operation operation);
+        void submit(I2CExecutor::Operation operation, I2CExecutor::Completion completion);
+        
+    protected:
+        explicit I2CBus(const std::string &devfile);
+        
+        int transferNow(struct i2c_msg *messages, uint32_t count);
+        
+        std::string devfile;
+        int file;
+        std::unique_ptr<I2CExecutor> executor;
+        
+        static std::mutex registryLock;
+        static std::map<std::string, std::weak_ptr<I2CBus> > registry;
+    };
+    
+} /* namespace i2cbus */
+
+#endif /* __I2CBus__ */
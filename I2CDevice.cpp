@@ -17,31 +17,106 @@
 
 namespace i2cbus {
     
+    /**
+     * Creates an empty transaction
+     */
+    I2CTransaction::I2CTransaction() {
+    }
+    
+    /**
+     * Queue a write message. The data is copied, so the caller's buffer may be reused immediately.
+     * @param data the bytes to write
+     * @param length the number of bytes to write
+     * @return the index of the queued message, used to look up its result
+     */
+    int I2CTransaction::write(const unsigned char *data, uint16_t length) {
+        Message message;
+        message.data.assign(data, data + length);
+        message.readBuffer = NULL;
+        message.length = length;
+        message.isRead = false;
+        message.result = RESULT_PENDING;
+        this->messages.push_back(message);
+        return this->messages.size() - 1;
+    }
+    
+    /**
+     * Queue a read message. The buffer must remain valid until the transaction has been transferred.
+     * @param buffer the buffer which receives the bytes read
+     * @param length the number of bytes to read
+     * @return the index of the queued message, used to look up its result
+     */
+    int I2CTransaction::read(unsigned char *buffer, uint16_t length) {
+        Message message;
+        message.readBuffer = buffer;
+        message.length = length;
+        message.isRead = true;
+        message.result = RESULT_PENDING;
+        this->messages.push_back(message);
+        return this->messages.size() - 1;
+    }
+    
+    /**
+     * Remove all queued messages so the transaction can be reused
+     */
+    void I2CTransaction::clear() {
+        this->messages.clear();
+    }
+    
+    /**
+     * @return the number of queued messages
+     */
+    int I2CTransaction::size() const {
+        return this->messages.size();
+    }
+    
+    /**
+     * Result of a single message after the transaction has been transferred
+     * @param index the message index returned when it was queued
+     * @return RESULT_OK if the message was sent, RESULT_FAILED if its ioctl failed, or
+     * RESULT_PENDING if it was never submitted
+     */
+    int I2CTransaction::getResult(int index) const {
+        if ((index < 0) || (index >= (int)this->messages.size())) {
+            return RESULT_PENDING;
+        }
+        return this->messages[index].result;
+    }
+    
     /**
      * Default constructor
      */
     I2CDevice::I2CDevice() {
-        this->file = -1;
     }
     
     /**
      * Constructor for the I2CDevice class. It requires the bus number and addr number. The constructor
-     * opens a file handle to the I2C device, which is destroyed when the destructor is called
+     * attaches to the shared bus for the dev file, which is released when the destructor is called
      * @param devfile The bus number. Usually 0 or 1 on the BBB
      * @param addr The addr ID on the bus.
      */
     I2CDevice::I2CDevice(std::string devfile, uint32_t addr) {
         this->devfile = devfile;
         this->addr = addr;
-        this->file = -1;
         this->open();
     }
     
     /**
-     * Closes the file on destruction, provided that it has not already been closed.
+     * Constructor for a device reached through a transport other than a /dev file, such as a
+     * simulated device. The transport is shared and may carry other devices as well.
+     * @param transport The transport which carries messages to the device
+     * @param addr The addr ID on the bus.
+     */
+    I2CDevice::I2CDevice(std::shared_ptr<I2CTransport> transport, uint32_t addr) {
+        this->addr = addr;
+        this->transport = transport;
+    }
+    
+    /**
+     * Releases the bus on destruction, provided that it has not already been released.
      */
     I2CDevice::~I2CDevice() {
-        if(file!=-1) this->close();
+        if(transport) this->close();
     }
     
     /**
@@ -61,26 +136,51 @@ namespace i2cbus {
     }
 
     /**
-     * Open a connection to an I2C device
+     * Provides a mechanism for using a transport other than the dev file, in case the object was
+     * constructed without one. Replaces any bus the device already holds.
+     * @param transport The transport which carries messages to the device
+     */
+    void I2CDevice::setTransport(std::shared_ptr<I2CTransport> transport) {
+        this->transport = transport;
+    }
+
+    /**
+     * Sets how operations which fail transiently are retried
+     * @param policy the number of attempts, the pause between them and the time budget per operation
+     */
+    void I2CDevice::setRetryPolicy(const I2CRetryPolicy &policy) {
+        this->retryPolicy = policy;
+    }
+    
+    /**
+     * @return the policy used to retry operations which fail transiently
+     */
+    I2CRetryPolicy I2CDevice::getRetryPolicy() const {
+        return this->retryPolicy;
+    }
+
+    /**
+     * Open a connection to an I2C device through the shared bus for its dev file. A device which
+     * already has a transport is left connected to it.
      * @return 1 on failure to open to the bus or device, 0 on success.
      */
     int I2CDevice::open() {
         
+        if (this->transport) {
+            return 0;
+        }
+        
         if ((this->addr == 0) || (this->devfile == "")) {
             std::cerr << "I2CDevice: Insufficient information to open device. Missing dev file or address" << std::endl;
             return 1;
         }
         
-        if((this->file=::open(this->devfile.c_str(), O_RDWR)) < 0){
+        // the device is addressed on every transfer, so the bus itself is never bound to it
+        if(!(this->transport = I2CBus::acquire(this->devfile))){
             std::cerr << "I2CDevice: Failed to open the bus" << std::endl;
             return 1;
         }
         
-        if(ioctl(this->file, I2C_SLAVE, this->addr) < 0){
-            std::cerr << "I2CDevice: Failed to connect to the device" << std::endl;
-            return 1;
-        }
-        
         return 0;
         
     }
@@ -95,7 +195,7 @@ namespace i2cbus {
         unsigned char buffer[2];
         buffer[0] = registerAddress;
         buffer[1] = value;
-        if(::write(this->file, buffer, 2)!=2){
+        if(!this->write(buffer, 2).ok()){
             std::cerr << "I2CDevice: Failed write to the device register" << std::endl;
             return 1;
         }
@@ -111,41 +211,179 @@ namespace i2cbus {
     int I2CDevice::write(unsigned char value){
         unsigned char buffer[1];
         buffer[0]=value;
-        if (::write(this->file, buffer, 1)!=1){
+        if (!this->write(buffer, 1).ok()){
             std::cerr << "I2CDevice: Failed to write to the device" << std::endl;
             return 1;
         }
         return 0;
     }
     
+    /**
+     * Write a buffer to the I2C device as a single message.
+     * @param buffer the bytes to write
+     * @param length the number of bytes to write
+     * @return the outcome of the write
+     */
+    I2CResult I2CDevice::write(const unsigned char *buffer, uint16_t length){
+        struct i2c_msg message;
+        message.addr = this->addr;
+        message.flags = 0;
+        message.len = length;
+        message.buf = const_cast<unsigned char *>(buffer);
+        
+        return this->submit(&message, 1);
+    }
+    
+    /**
+     * Write a buffer to the device and then read back from it as a single combined transaction.
+     * The two messages are joined by a repeated start, so the bus is not released between setting
+     * the register pointer and reading the data, and only one system call is made.
+     * @param writeBuffer the bytes to write, usually the register address
+     * @param writeLength the number of bytes to write
+     * @param readBuffer the buffer which receives the bytes read
+     * @param readLength the number of bytes to read
+     * @return the outcome of the transaction
+     */
+    I2CResult I2CDevice::writeRead(const unsigned char *writeBuffer, uint16_t writeLength, unsigned char *readBuffer, uint16_t readLength) {
+        struct i2c_msg messages[2];
+        messages[0].addr = this->addr;
+        messages[0].flags = 0;
+        messages[0].len = writeLength;
+        messages[0].buf = const_cast<unsigned char *>(writeBuffer);
+        messages[1].addr = this->addr;
+        messages[1].flags = I2C_M_RD;
+        messages[1].len = readLength;
+        messages[1].buf = readBuffer;
+        
+        I2CResult result = this->submit(messages, 2);
+        if (!result.ok()) {
+            std::cerr << "I2CDevice: Failed combined write and read transaction: " << strerror(result.error) << std::endl;
+        }
+        return result;
+    }
+    
+    /**
+     * Submit every message queued in a transaction with as few I2C_RDWR calls as possible. The
+     * messages are split into chunks no larger than the kernel limit, never separating a read from
+     * the write which precedes it. Each chunk is retried under the retry policy; when a chunk still
+     * fails, it is marked failed and the remaining chunks are left pending.
+     * @param transaction the queued messages, whose per-message results are updated
+     * @return the outcome of the first failed chunk, or success with the total attempts made
+     */
+    I2CResult I2CDevice::transfer(I2CTransaction &transaction) {
+        std::vector<I2CTransaction::Message> &queued = transaction.messages;
+        struct i2c_msg messages[I2C_RDWR_IOCTL_MAX_MSGS];
+        int total = queued.size();
+        int start = 0;
+        I2CResult result;
+        
+        while (start < total) {
+            int end = start + I2C_RDWR_IOCTL_MAX_MSGS;
+            if (end >= total) {
+                end = total;
+            }
+            else if (queued[end].isRead && (end - 1 > start)) {
+                // keep the register pointer write with its read
+                end--;
+            }
+            
+            for (int i = start; i < end; i++) {
+                I2CTransaction::Message &message = queued[i];
+                messages[i - start].addr = this->addr;
+                messages[i - start].flags = message.isRead ? I2C_M_RD : 0;
+                messages[i - start].len = message.length;
+                if (message.isRead) {
+                    messages[i - start].buf = message.readBuffer;
+                }
+                else {
+                    messages[i - start].buf = message.data.empty() ? NULL : &message.data[0];
+                }
+            }
+            
+            I2CResult chunk = this->submit(messages, end - start);
+            result.attempts += chunk.attempts;
+            
+            for (int i = start; i < end; i++) {
+                queued[i].result = chunk.ok() ? I2CTransaction::RESULT_OK : I2CTransaction::RESULT_FAILED;
+            }
+            
+            if (!chunk.ok()) {
+                std::cerr << "I2CDevice: Failed transaction at message " << start << " of " << total << ": " << strerror(chunk.error) << std::endl;
+                result.error = chunk.error;
+                return result;
+            }
+            
+            start = end;
+        }
+        
+        return result;
+    }
+    
+    /**
+     * Read a single register value from the address on the device, reporting failure separately
+     * from the value.
+     * @param registerAddress the address to read from
+     * @param value receives the byte value at the register address, untouched on failure
+     * @return the outcome of the read
+     */
+    I2CResult I2CDevice::readRegister(uint32_t registerAddress, unsigned char &value){
+        unsigned char address[1];
+        address[0] = registerAddress;
+        unsigned char buffer[1];
+        I2CResult result = this->writeRead(address, 1, buffer, 1);
+        if (result.ok()) {
+            value = buffer[0];
+        }
+        return result;
+    }
+    
     /**
      * Read a single register value from the address on the device.
      * @param registerAddress the address to read from
      * @return the byte value at the register address.
      */
     unsigned char I2CDevice::readRegister(uint32_t registerAddress){
-        this->write(registerAddress);
+        unsigned char address[1];
+        address[0] = registerAddress;
         unsigned char buffer[1];
-        if(::read(this->file, buffer, 1)!=1){
+        if (!this->writeRead(address, 1, buffer, 1).ok()) {
             std::cerr << "I2CDevice: Failed to read in the value." << std::endl;
             return 1;
         }
         return buffer[0];
     }
     
+    /**
+     * Method to read a number of registers from a single device into a buffer owned by the caller.
+     * This is much more efficient than reading the registers individually, and makes no allocation.
+     * @param buffer the buffer which receives the register values, at least number bytes long
+     * @param number the number of registers to read from the device
+     * @param fromAddress the starting address to read from
+     * @return the number of registers read, or -1 on failure
+     */
+    int I2CDevice::readRegisters(unsigned char *buffer, uint32_t number, uint32_t fromAddress){
+        unsigned char address[1];
+        address[0] = fromAddress;
+        if(!this->writeRead(address, 1, buffer, number).ok()){
+            std::cerr << "I2CDevice: Failed to read in the full buffer." << std::endl;
+            return -1;
+        }
+        return number;
+    }
+    
     /**
      * Method to read a number of registers from a single device. This is much more efficient than
      * reading the registers individually. The from address is the starting address to read from, which
-     * defaults to 0x00.
+     * defaults to 0x00. Prefer the overload taking a buffer on any path which is called repeatedly.
      * @param number the number of registers to read from the device
      * @param fromAddress the starting address to read from
-     * @return a pointer of type unsigned char* that points to the first element in the block of registers
+     * @return a pointer of type unsigned char* that points to the first element in the block of registers,
+     * which the caller must delete[], or NULL on failure
      */
     unsigned char* I2CDevice::readRegisters(uint32_t number, uint32_t fromAddress){
-        this->write(fromAddress);
         unsigned char* data = new unsigned char[number];
-        if(::read(this->file, data, number)!=(int)number){
-            std::cerr << "I2CDevice: Failed to read in the full buffer." << std::endl;
+        if(this->readRegisters(data, number, fromAddress)!=(int)number){
+            delete[] data;
             return NULL;
         }
         return data;
@@ -160,21 +398,81 @@ namespace i2cbus {
      */
     
     void I2CDevice::debugDumpRegisters(uint32_t number){
+        // register addresses are a single byte, so the whole map fits on the stack
+        unsigned char registers[0x100];
+        if (number > sizeof(registers)) {
+            number = sizeof(registers);
+        }
+        
         std::cerr << "I2CDevice: Dumping Registers for Debug Purposes:" << std::endl;
-        unsigned char *registers = this->readRegisters(number);
+        if (this->readRegisters(registers, number) != (int)number) {
+            return;
+        }
         for(int i=0; i<(int)number; i++){
-            std::cerr << HEX(*(registers+i)) << " ";
-            if (i%16==15) std::cout << std::endl;
+            std::cerr << HEX(registers[i]) << " ";
+            if (i%16==15) std::cerr << std::endl;
         }
         std::cerr << std::dec;
     }
     
     /**
-     * Close the file handles and sets a temporary state to -1.
+     * Submit messages to the transport, retrying transient failures under the retry policy. A retry
+     * is only made if it can start within the time budget; the budget cannot interrupt a transfer
+     * which is already on the bus.
+     * @param messages the messages to send
+     * @param count the number of messages
+     * @return the outcome, with ETIMEDOUT when the budget ran out before a retry could succeed
+     */
+    I2CResult I2CDevice::submit(struct i2c_msg *messages, uint32_t count) {
+        I2CResult result;
+        
+        if (!this->transport) {
+            result.error = ENODEV;
+            return result;
+        }
+        
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::chrono::microseconds budget(this->retryPolicy.timeoutUs);
+        std::chrono::microseconds delay(this->retryPolicy.retryDelayUs);
+        
+        while (true) {
+            result.attempts++;
+            result.error = this->transport->transfer(messages, count);
+            
+            if (result.ok() || !isTransient(result.error) || (result.attempts >= this->retryPolicy.maxAttempts)) {
+                return result;
+            }
+            
+            if ((budget.count() > 0) && (std::chrono::steady_clock::now() + delay - start > budget)) {
+                result.error = ETIMEDOUT;
+                return result;
+            }
+            
+            std::this_thread::sleep_for(delay);
+        }
+    }
+    
+    /**
+     * @return true for failures which may succeed when retried: a NACK, a busy or timed out
+     * adapter, or lost arbitration
+     */
+    bool I2CDevice::isTransient(int error) {
+        switch (error) {
+            case EREMOTEIO:
+            case ENXIO:
+            case EAGAIN:
+            case ETIMEDOUT:
+                return true;
+            default:
+                return false;
+        }
+    }
+    
+    /**
+     * Release this device's hold on the shared bus. The bus file is closed once no device holds it.
      */
     void I2CDevice::close(){
-        ::close(this->file);
-        this->file = -1;
+        this->transport.reset();
     }
     
 } /* namespace 12cbus */
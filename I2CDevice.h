@@ -18,6 +18,11 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <errno.h>
+#include <string.h>
 #include <fcntl.h>
 #include <iomanip>
 #include <stdio.h>
@@ -32,10 +37,64 @@
 #include <linux/i2c.h>
 #endif
 
+#include "I2CBus.h"
+
 #define HEX(x) std::setw(2) << std::setfill('0') << std::hex << (int)(x)
 
 namespace i2cbus {
     
+    /**
+     * @brief Outcome of an I2C operation
+     */
+    struct I2CResult {
+        int error = 0;      // 0 on success, otherwise the errno describing the failure
+        int attempts = 0;   // number of times the operation was submitted
+        
+        bool ok() const { return error == 0; }
+    };
+    
+    /**
+     * @brief How an I2CDevice retries operations which fail transiently (NACK, EAGAIN, EREMOTEIO)
+     */
+    struct I2CRetryPolicy {
+        int maxAttempts = 3;          // total submissions including the first, at least 1
+        uint32_t retryDelayUs = 500;  // pause between attempts
+        uint32_t timeoutUs = 20000;   // budget for the whole operation including retries, 0 for none
+    };
+    
+    /**
+     * @class I2CTransaction
+     * @brief Queue of write and read messages which an I2CDevice submits together through I2C_RDWR
+     */
+    class I2CTransaction {
+        
+    public:
+        I2CTransaction();
+        
+        static const int RESULT_PENDING = -1;
+        static const int RESULT_OK = 0;
+        static const int RESULT_FAILED = 1;
+        
+        int write(const unsigned char *data, uint16_t length);
+        int read(unsigned char *buffer, uint16_t length);
+        void clear();
+        int size() const;
+        int getResult(int index) const;
+        
+    protected:
+        friend class I2CDevice;
+        
+        struct Message {
+            std::vector<unsigned char> data;
+            unsigned char *readBuffer;
+            uint16_t length;
+            bool isRead;
+            int result;
+        };
+        
+        std::vector<Message> messages;
+    };
+    
     /**
      * @class I2CDevice
      * @brief Generic I2C Device class that can be used to connect to any type of I2C device and read or write to its registers
@@ -45,22 +104,35 @@ namespace i2cbus {
     public:
         I2CDevice();
         I2CDevice(std::string devfile, uint32_t addr);
+        I2CDevice(std::shared_ptr<I2CTransport> transport, uint32_t addr);
         ~I2CDevice();
         
         void setDevfile(std::string devfile);
         void setAddr(uint32_t addr);
+        void setTransport(std::shared_ptr<I2CTransport> transport);
+        void setRetryPolicy(const I2CRetryPolicy &policy);
+        I2CRetryPolicy getRetryPolicy() const;
         int open();
         int write(unsigned char value);
+        I2CResult write(const unsigned char *buffer, uint16_t length);
+        I2CResult writeRead(const unsigned char *writeBuffer, uint16_t writeLength, unsigned char *readBuffer, uint16_t readLength);
+        I2CResult transfer(I2CTransaction &transaction);
+        I2CResult readRegister(uint32_t registerAddress, unsigned char &value);
         unsigned char readRegister(uint32_t registerAddress);
+        int readRegisters(unsigned char *buffer, uint32_t number, uint32_t fromAddress=0);
         unsigned char* readRegisters(uint32_t number, uint32_t fromAddress=0);
         int writeRegister(uint32_t registerAddress, unsigned char value);
         void debugDumpRegisters(uint32_t number = 0xff);
         void close();
         
     protected:
+        I2CResult submit(struct i2c_msg *messages, uint32_t count);
+        static bool isTransient(int error);
+        
         std::string devfile = "";
         uint32_t addr = 0;
-        int file;
+        std::shared_ptr<I2CTransport> transport;
+        I2CRetryPolicy retryPolicy;
     };
     
 } /* namespace i2cbus */
@@ -0,0 +1,146 @@
+/**
+ * \file I2CExecutor.cpp
+ *
+ *  Copyright (c) 2026 Agilatech. All rights reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "I2CExecutor.h"
+
+namespace i2cbus {
+    
+    /**
+     * Creates the queue and starts the executor thread
+     */
+    I2CExecutor::I2CExecutor() : head(&stub), tail(&stub), stopping(false), sleeping(false) {
+        this->stub.next.store(NULL);
+        this->worker = std::thread(&I2CExecutor::run, this);
+    }
+    
+    /**
+     * Runs every operation already submitted, then stops the executor thread. Completions must not
+     * release the last reference to the executor's owner, since the thread cannot join itself.
+     */
+    I2CExecutor::~I2CExecutor() {
+        {
+            std::lock_guard<std::mutex> guard(this->wakeLock);
+            this->stopping.store(true);
+        }
+        this->wake.notify_one();
+        this->worker.join();
+    }
+    
+    /**
+     * Queue an operation for the executor thread
+     * @param operation the work to run, returning 0 or an errno value
+     * @return a future which receives the operation's result
+     */
+    std::future<int> I2CExecutor::submit(Operation operation) {
+        std::shared_ptr<std::promise<int> > promise(new std::promise<int>());
+        std::future<int> result = promise->get_future();
+        
+        this->submit(operation, [promise](int error) { promise->set_value(error); });
+        
+        return result;
+    }
+    
+    /**
+     * Queue an operation for the executor thread
+     * @param operation the work to run, returning 0 or an errno value
+     * @param completion called on the executor thread with the operation's result
+     */
+    void I2CExecutor::submit(Operation operation, Completion completion) {
+        Node *node = new Node();
+        node->operation = operation;
+        node->completion = completion;
+        
+        this->push(node);
+        
+        // the executor publishes that it is about to sleep before its last look at the queue,
+        // so either it sees this node or this sees it sleeping
+        if (this->sleeping.load()) {
+            std::lock_guard<std::mutex> guard(this->wakeLock);
+            this->wake.notify_one();
+        }
+    }
+    
+    /**
+     * @return true when called from the executor thread, where operations may touch the bus directly
+     */
+    bool I2CExecutor::isExecutorThread() const {
+        return std::this_thread::get_id() == this->worker.get_id();
+    }
+    
+    void I2CExecutor::push(Node *node) {
+        node->next.store(NULL);
+        Node *previous = this->head.exchange(node);
+        previous->next.store(node);
+    }
+    
+    // Takes the oldest node, or NULL if the queue is empty or a producer is part way through a push
+    I2CExecutor::Node *I2CExecutor::pop() {
+        Node *last = this->tail;
+        Node *next = last->next.load();
+        
+        if (last == &this->stub) {
+            if (next == NULL) {
+                return NULL;
+            }
+            this->tail = next;
+            last = next;
+            next = next->next.load();
+        }
+        
+        if (next != NULL) {
+            this->tail = next;
+            return last;
+        }
+        
+        if (last != this->head.load()) {
+            return NULL;
+        }
+        
+        // last is the only node, so park the stub behind it before handing it out
+        this->push(&this->stub);
+        
+        next = last->next.load();
+        if (next != NULL) {
+            this->tail = next;
+            return last;
+        }
+        
+        return NULL;
+    }
+    
+    void I2CExecutor::run() {
+        while (true) {
+            Node *node = this->pop();
+            
+            if (node == NULL) {
+                std::unique_lock<std::mutex> lock(this->wakeLock);
+                this->sleeping.store(true);
+                while (((node = this->pop()) == NULL) && !this->stopping.load()) {
+                    this->wake.wait(lock);
+                }
+                this->sleeping.store(false);
+                
+                if (node == NULL) {
+                    return;
+                }
+            }
+            
+            int error = node->operation();
+            if (node->completion) {
+                node->completion(error);
+            }
+            delete node;
+        }
+    }
+    
+} /* namespace i2cbus */
@@ -0,0 +1,74 @@
+/**
+ * \file I2CExecutor.h
+ *
+ *  Copyright (c) 2026 Agilatech. All rights reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __I2CExecutor__
+#define __I2CExecutor__
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace i2cbus {
+    
+    /**
+     * @class I2CExecutor
+     * @brief A thread which runs bus operations one at a time, in the order they were submitted
+     *
+     * Any thread may submit an operation without blocking. Submissions go onto a lock-free multiple
+     * producer, single consumer queue which the executor thread drains; the thread only sleeps on a
+     * condition variable when the queue is empty. Operations return 0 or an errno value, delivered
+     * through a future or a callback which runs on the executor thread.
+     */
+    class I2CExecutor {
+        
+    public:
+        typedef std::function<int()> Operation;
+        typedef std::function<void(int)> Completion;
+        
+        I2CExecutor();
+        ~I2CExecutor();
+        
+        std::future<int> submit(Operation operation);
+        void submit(Operation operation, Completion completion);
+        bool isExecutorThread() const;
+        
+    protected:
+        struct Node {
+            std::atomic<Node *> next;
+            Operation operation;
+            Completion completion;
+        };
+        
+        void push(Node *node);
+        Node *pop();
+        void run();
+        
+        // producers exchange the head, the executor thread alone advances the tail
+        std::atomic<Node *> head;
+        Node *tail;
+        Node stub;
+        
+        std::atomic<bool> stopping;
+        std::atomic<bool> sleeping;
+        std::mutex wakeLock;
+        std::condition_variable wake;
+        std::thread worker;
+    };
+    
+} /* namespace i2cbus */
+
+#endif /* __I2CExecutor__ */
@@ -0,0 +1,50 @@
+/**
+ * \file I2CTransport.h
+ *
+ *  Copyright (c) 2026 Agilatech. All rights reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __I2CTransport__
+#define __I2CTransport__
+
+#include <stdint.h>
+#include <linux/i2c-dev.h>
+
+// see I2CDevice.h for why linux/i2c.h is conditionally included
+#ifndef I2C_FUNC_I2C
+#include <linux/i2c.h>
+#endif
+
+namespace i2cbus {
+    
+    /**
+     * @class I2CTransport
+     * @brief Anything which can carry I2C messages for an I2CDevice
+     *
+     * The messages use the same layout as the I2C_RDWR ioctl, so a transport is free to hand them
+     * straight to the kernel (I2CBus) or to interpret them itself (for example a simulated device).
+     */
+    class I2CTransport {
+        
+    public:
+        virtual ~I2CTransport() {}
+        
+        /**
+         * Submit a group of messages as one combined transaction
+         * @param messages the messages to send, each beginning with a (repeated) start
+         * @param count the number of messages, no more than I2C_RDWR_IOCTL_MAX_MSGS
+         * @return 0 on success, otherwise an errno value describing the failure
+         */
+        virtual int transfer(struct i2c_msg *messages, uint32_t count) =0;
+    };
+    
+} /* namespace i2cbus */
+
+#endif /* __I2CTransport__ */
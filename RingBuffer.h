@@ -0,0 +1,87 @@
+/**
+ * \file RingBuffer.h
+ *
+ *  Copyright (c) 2026 Agilatech. All rights reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __RingBuffer__
+#define __RingBuffer__
+
+#include <atomic>
+#include <stddef.h>
+
+/**
+ * @class RingBuffer
+ * @brief Fixed capacity, lock-free queue for one producer thread and one consumer thread
+ *
+ * The producer never waits: when the buffer is full the new item is refused and counted as dropped,
+ * so the items the consumer has not yet collected are never overwritten underneath it.
+ */
+template <typename T, size_t N>
+class RingBuffer {
+    
+public:
+    RingBuffer() : head(0), tail(0), dropped(0) {}
+    
+    // Producer side. Returns false, and counts a drop, when the buffer is full.
+    bool push(const T &item) {
+        size_t h = this->head.load(std::memory_order_relaxed);
+        if (h - this->tail.load(std::memory_order_acquire) >= N) {
+            this->dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        this->items[h % N] = item;
+        this->head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Consumer side. Returns false when the buffer is empty.
+    bool pop(T &item) {
+        size_t t = this->tail.load(std::memory_order_relaxed);
+        if (t == this->head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = this->items[t % N];
+        this->tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Consumer side. Moves up to max of the oldest items into the array, returning how many.
+    size_t drain(T *out, size_t max) {
+        size_t t = this->tail.load(std::memory_order_relaxed);
+        size_t available = this->head.load(std::memory_order_acquire) - t;
+        size_t count = (available < max) ? available : max;
+        for (size_t i = 0; i < count; i++) {
+            out[i] = this->items[(t + i) % N];
+        }
+        this->tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+    
+    size_t size() const {
+        return this->head.load(std::memory_order_acquire) - this->tail.load(std::memory_order_acquire);
+    }
+    
+    size_t capacity() const {
+        return N;
+    }
+    
+    size_t getDropped() const {
+        return this->dropped.load(std::memory_order_relaxed);
+    }
+    
+private:
+    T items[N];
+    std::atomic<size_t> head;
+    std::atomic<size_t> tail;
+    std::atomic<size_t> dropped;
+};
+
+#endif /* __RingBuffer__ */
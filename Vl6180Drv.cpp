@@ -22,6 +22,33 @@ const int Device::numValues = Vl6180Drv::NUM_VALUES;
 const std::string Device::valueNames[numValues] = {"range", "lux"};
 const std::string Device::valueTypes[numValues] = {"integer", "float"};
 
+// Actual ALS analog gains from the datasheet, in increasing order, which differ
+// slightly from the nominal gains the codes are named for
+const Vl6180Drv::AlsGain Vl6180Drv::alsGains[] = {
+    { VL6180_ALS_GAIN_1,    1.01 },
+    { VL6180_ALS_GAIN_1_25, 1.28 },
+    { VL6180_ALS_GAIN_1_67, 1.72 },
+    { VL6180_ALS_GAIN_2_5,  2.60 },
+    { VL6180_ALS_GAIN_5,    5.21 },
+    { VL6180_ALS_GAIN_10,   10.32 },
+    { VL6180_ALS_GAIN_20,   20.0 },
+    { VL6180_ALS_GAIN_40,   40.0 }
+};
+
+// Register values for each named timing profile, indexed by Vl6180TimingProfile.
+// Max-rate gives up range on dark targets and noise for a 20ms range period,
+// low-noise averages for longest and recalibrates for temperature every 64 ranges.
+const Vl6180Timing Vl6180Drv::timingProfiles[] = {
+    { 12, 0x00, 0xFF, 0x7B, 0x01, 0x0B },
+    { 50, 0x30, 0xFF, 0x7B, 0x09, 0x31 },
+    { 63, 0xFF, 0x40, 0x7B, 0x09, 0x31 }
+};
+
+const char *Vl6180Drv::timingNames[] = { "max-rate", "balanced", "low-noise", "custom" };
+
+// Integration periods in ms available to auto ranging, in increasing order
+const uint16_t Vl6180Drv::alsPeriods[] = { 25, 50, 100, 200 };
+
 Vl6180Drv::Vl6180Drv(std::string devfile, uint32_t addr):i2cbus::I2CDevice(devfile,addr) {
     
     if (initialize()) {
@@ -33,22 +60,87 @@ Vl6180Drv::Vl6180Drv(std::string devfile, uint32_t addr):i2cbus::I2CDevice(devfi
     
 }
 
+Vl6180Drv::Vl6180Drv(std::shared_ptr<i2cbus::I2CTransport> transport, uint32_t addr):i2cbus::I2CDevice(transport,addr) {
+    
+    if (initialize()) {
+        this->active = true;
+    }
+    else {
+        std::cerr << name << " did not initialize. " << name << " is inactive" << std::endl;
+    }
+    
+}
+
+Vl6180Drv::~Vl6180Drv() {
+    stopContinuous();
+}
+
 std::string Vl6180Drv::getValueAtIndex(int index) {
     
     if (!this->active) {
         return "none";
     }
     
-    if (index < numValues) {
-        return (this->*readFunction[index])();
+    if ((index >= 0) && (index < numValues)) {
+        return coalesce<std::string>(this->textInFlight[index], [this, index]() {
+            std::lock_guard<std::mutex> guard(this->lock);
+            return (this->*readFunction[index])();
+        });
     }
     else {
         return "none";
     }
 }
 
+// Runs measure for the first caller. Callers which arrive while it is running wait for it
+// and share its result rather than queueing measurements of their own.
+template <typename T>
+T Vl6180Drv::coalesce(std::shared_future<T> &slot, const std::function<T()> &measure) {
+    std::promise<T> promise;
+    std::shared_future<T> pending;
+    
+    {
+        std::lock_guard<std::mutex> guard(this->flightLock);
+        if (slot.valid()) {
+            pending = slot;
+        }
+        else {
+            slot = promise.get_future().share();
+        }
+    }
+    
+    if (pending.valid()) {
+        return pending.get();
+    }
+    
+    T value;
+    try {
+        value = measure();
+    }
+    catch (...) {
+        // the waiting callers get the same exception, and the next caller measures again
+        promise.set_exception(std::current_exception());
+        {
+            std::lock_guard<std::mutex> guard(this->flightLock);
+            slot = std::shared_future<T>();
+        }
+        throw;
+    }
+    
+    // later callers start a new measurement, as this result is now on its way out
+    {
+        std::lock_guard<std::mutex> guard(this->flightLock);
+        slot = std::shared_future<T>();
+    }
+    promise.set_value(value);
+    
+    return value;
+}
+
 bool Vl6180Drv::initialize() {
     
+    this->lastError = 0;
+    
     if (read8(VL6180_IDENTIFICATION_MODEL_ID) != 0xB4) {
         return false;
     }
@@ -57,41 +149,195 @@ bool Vl6180Drv::initialize() {
     
     write8(VL6180_SYSTEM_FRESH_OUT_OF_RESET, 0x00);
 
-    return true;
+    return (this->lastError == 0);
 }
 
 std::string Vl6180Drv::readValue0() {
     
-    if (!this->active) {
+    uint8_t range;
+    if (!rangeValue(range)) {
         return "none";
     }
     
-    unsigned char range_status;
-    unsigned char status;
+    return DataManip::dataToString(range);
+}
+
+// The range in mm from the newest sample in a continuous mode, or from a new single shot
+// measurement. False when there is no valid range. Called with lock held.
+bool Vl6180Drv::rangeValue(uint8_t &range) {
+    
+    if (!this->active || this->rangePending) {
+        return false;
+    }
+    
+    // the sensor is already free-running, so report the newest sample it produced
+    if ((this->mode == VL6180_MODE_CONTINUOUS_RANGE) || (this->mode == VL6180_MODE_RANGE_HISTORY)) {
+        RangeSample sample;
+        if (!latestRange(sample) || !sample.valid) {
+            return false;
+        }
+        range = sample.range;
+        return true;
+    }
+    else if (this->mode == VL6180_MODE_INTERLEAVED) {
+        InterleavedSample sample;
+        if (!latestInterleaved(sample) || !sample.rangeValid) {
+            return false;
+        }
+        range = sample.range;
+        return true;
+    }
+    else if (this->mode == VL6180_MODE_RANGE_EVENTS) {
+        // each continuous measurement lands in the result register, event or not
+        this->lastError = 0;
+        range = read8(VL6180_RESULT_RANGE_VAL);
+        return (this->lastError == 0);
+    }
+    else if (this->mode == VL6180_MODE_ALS_EVENTS) {
+        return false;
+    }
+    
+    RangeSample sample;
+    if (!measureRange(sample) || !sample.valid) {
+        return false;
+    }
+    
+    range = sample.range;
+    return true;
+}
+
+// Takes one range measurement with its error code and signal diagnostics
+bool Vl6180Drv::readRange(RangeSample &sample) {
+    
+    if (!this->active) {
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> guard(this->lock);
+    
+    if ((this->mode != VL6180_MODE_SINGLE_SHOT) || this->rangePending) {
+        return false;
+    }
+    
+    return measureRange(sample);
+}
+
+// Runs a single shot range measurement and reads the whole result window in one burst.
+// Returns false if the bus or the sensor failed; a measurement the sensor rejected
+// comes back with its error code and valid false. Called with lock held.
+bool Vl6180Drv::measureRange(RangeSample &sample) {
+    
+    this->lastError = 0;
     
     // wait for device to be ready for range measurement
-    while (! (read8(VL6180_RESULT_RANGE_STATUS) & 0x01));
+    waitForRegister(VL6180_RESULT_RANGE_STATUS, 0x01, 0x01, 0, maximumRangeUs());
+    
+    beginRange();
+    
+    // wait for new measurement ready status
+    waitForRegister(VL6180_RESULT_INTERRUPT_STATUS_GPIO, 0x07, 0x04, minimumRangeUs(), maximumRangeUs());
     
-    // Start a range measurement
+    return finishRange(sample);
+}
+
+// Starts a single shot range measurement. Called with lock held.
+void Vl6180Drv::beginRange() {
+    this->interruptLine.clear();
     write8(VL6180_SYSRANGE_START, 0x01);
+}
+
+// Reads and clears a completed range measurement, returning false if any register
+// access in the measurement failed. Called with lock held.
+bool Vl6180Drv::finishRange(RangeSample &sample) {
     
-    // check the status
-    status = read8(VL6180_RESULT_INTERRUPT_STATUS_GPIO);
-    range_status = status & 0x07;
+    Vl6180Results results;
+    readResults(results);
     
-    // wait for new measurement ready status
-    while (range_status != 0x04) {
-        status = read8(VL6180_RESULT_INTERRUPT_STATUS_GPIO);
-        range_status = status & 0x07;
+    // clear interrupt
+    write8(VL6180_SYSTEM_INTERRUPT_CLEAR, 0x07);
+    
+    if (this->lastError) {
+        return false;
     }
     
-    // read range in mm
-    uint8_t range = read8(VL6180_RESULT_RANGE_VAL);
+    decodeRange(results, sample);
+    sample.timestamp = now();
+    
+    return true;
+}
+
+// Starts a range measurement without waiting for it, so that measurements on several
+// sensors can run at once. Follow with pollRange until it is ready, then collectRange.
+// Other range reads fail while the measurement is pending.
+bool Vl6180Drv::startRange() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    
+    if (!this->active || (this->mode != VL6180_MODE_SINGLE_SHOT) || this->rangePending) {
+        return false;
+    }
+    
+    this->lastError = 0;
+    
+    // the device has to be idle, as it is between measurements
+    if (!(read8(VL6180_RESULT_RANGE_STATUS) & 0x01) || this->lastError) {
+        return false;
+    }
+    
+    beginRange();
+    
+    if (this->lastError) {
+        return false;
+    }
+    
+    this->rangePending = true;
+    this->rangeDeadline = now() + measurementDeadlineUs(maximumRangeUs());
+    
+    return true;
+}
+
+// Looks once at a measurement begun by startRange. Returns 1 when it can be collected,
+// 0 while it is still converging, or -1 if it failed or ran past its deadline, which
+// abandons it.
+int Vl6180Drv::pollRange() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    
+    if (!this->rangePending) {
+        return -1;
+    }
+    
+    this->lastError = 0;
+    
+    unsigned char status = read8(VL6180_RESULT_INTERRUPT_STATUS_GPIO);
+    if (!this->lastError && ((status & 0x07) == 0x04)) {
+        return 1;
+    }
+    
+    if (!this->lastError && (now() < this->rangeDeadline)) {
+        return 0;
+    }
+    
+    if (!this->lastError) {
+        track(timedOut());
+    }
     
-    // clear interrupt
     write8(VL6180_SYSTEM_INTERRUPT_CLEAR, 0x07);
+    this->rangePending = false;
     
-    return DataManip::dataToString(range);
+    return -1;
+}
+
+// Reads the result of a measurement once pollRange has reported it ready
+bool Vl6180Drv::collectRange(RangeSample &sample) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    
+    if (!this->rangePending) {
+        return false;
+    }
+    
+    this->rangePending = false;
+    this->lastError = 0;
+    
+    return finishRange(sample);
 }
 
 std::string Vl6180Drv::readValue1() {
@@ -100,177 +346,1423 @@ std::string Vl6180Drv::readValue1() {
         return "none";
     }
     
+    AlsSample sample;
+    if (!measureAls(sample)) {
+        return "none";
+    }
+    
+    return DataManip::dataToString(sample.lux, 1);
+}
+
+// Range in mm, false when there is no valid range
+bool Vl6180Drv::getRange(uint8_t &range) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    return rangeValue(range);
+}
+
+// Lux, false when the measurement failed
+bool Vl6180Drv::getLux(float &lux) {
+    
+    if (!this->active) {
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> guard(this->lock);
+    
+    AlsSample sample;
+    if (!measureAls(sample)) {
+        return false;
+    }
+    
+    lux = sample.lux;
+    return true;
+}
+
+// Range at index 0 and lux at index 1 as numbers, without formatting them as strings
+bool Vl6180Drv::getNumberAtIndex(int index, double &value) {
+    
+    if ((index < 0) || (index >= numValues)) {
+        return false;
+    }
+    
+    std::pair<bool, double> result = coalesce<std::pair<bool, double>>(this->numberInFlight[index], [this, index]() {
+        std::pair<bool, double> number(false, 0);
+        if (index == 0) {
+            uint8_t range = 0;
+            number.first = getRange(range);
+            number.second = range;
+        }
+        else {
+            float lux = 0;
+            number.first = getLux(lux);
+            number.second = lux;
+        }
+        return number;
+    });
+    
+    if (result.first) {
+        value = result.second;
+    }
+    
+    return result.first;
+}
+// Takes one ALS measurement and reports the gain and integration period it used
+bool Vl6180Drv::readAls(AlsSample &sample) {
+    
+    if (!this->active) {
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> guard(this->lock);
+    return measureAls(sample);
+}
+
+// Measures ALS with the current gain and integration period, then picks the settings
+// for the next measurement when auto ranging is on. Called with lock held.
+bool Vl6180Drv::measureAls(AlsSample &sample) {
+    
+    // ALS is already free-running alongside ranging, so report the newest pair
+    if (this->mode == VL6180_MODE_INTERLEAVED) {
+        InterleavedSample pair;
+        if (!latestInterleaved(pair) || !pair.alsValid) {
+            return false;
+        }
+        sample.lux = pair.lux;
+        sample.counts = pair.alsCounts;
+        sample.gain = alsGainValue(this->alsGain);
+        sample.integrationMs = this->alsIntegrationMs;
+        sample.timestamp = pair.timestamp;
+        return true;
+    }
+    
+    // each continuous measurement lands in the result register, event or not
+    if (this->mode == VL6180_MODE_ALS_EVENTS) {
+        this->lastError = 0;
+        uint16_t counts = read16(VL6180_RESULT_ALS_VAL);
+        if (this->lastError || (counts == VL6180_ALS_SATURATED)) {
+            return false;
+        }
+        sample.lux = countsToLux(counts, this->alsGain, this->alsIntegrationMs);
+        sample.counts = counts;
+        sample.gain = alsGainValue(this->alsGain);
+        sample.integrationMs = this->alsIntegrationMs;
+        sample.timestamp = now();
+        return true;
+    }
+    
+    // a saturated count only says the light is at least that bright, so it is not reported.
+    // With auto ranging the measurement is repeated at the less sensitive settings chosen
+    // from it, until the count is in range or the least sensitive settings also saturate.
+    for (int attempt = 0; ; attempt++) {
+        uint8_t gain = this->alsGain;
+        uint16_t integrationMs = this->alsIntegrationMs;
+        uint16_t counts;
+        
+        if (!convertAls(gain, integrationMs, counts)) {
+            return false;
+        }
+        
+        if (this->alsAutoRange) {
+            selectAlsRange(counts);
+        }
+        
+        if (counts != VL6180_ALS_SATURATED) {
+            sample.lux = countsToLux(counts, gain, integrationMs);
+            sample.counts = counts;
+            sample.gain = alsGainValue(gain);
+            sample.integrationMs = integrationMs;
+            sample.timestamp = now();
+            return true;
+        }
+        
+        bool reranged = (gain != this->alsGain) || (integrationMs != this->alsIntegrationMs);
+        if (!reranged || (attempt >= VL6180_ALS_AUTO_RETRIES)) {
+            return false;
+        }
+    }
+}
+
+// Runs one single shot ALS measurement with the given gain and integration period.
+// Called with lock held.
+bool Vl6180Drv::convertAls(uint8_t gain, uint16_t integrationMs, uint16_t &counts) {
     uint8_t reg;
-    uint8_t gain = VL6180_ALS_GAIN_5; // start at 5x gain
     
-    reg = read8(VL6180_SYSTEM_INTERRUPT_CONFIG_GPIO);
+    this->lastError = 0;
+    
+    reg = readConfig8(VL6180_SYSTEM_INTERRUPT_CONFIG_GPIO);
     reg &= ~0x38;
     reg |= (0x4 << 3); // IRQ on ALS ready
-    write8(VL6180_SYSTEM_INTERRUPT_CONFIG_GPIO, reg);
     
-    // analog gain
-    if (gain > VL6180_ALS_GAIN_40) {
-        gain = VL6180_ALS_GAIN_40;
-    }
-
-    write8(VL6180_SYSALS_ANALOGUE_GAIN, 0x40 | gain);
+    // the configuration and start are sent as one transaction, and configuration
+    // which the device already holds is left out
+    i2cbus::I2CTransaction setup;
+    queueConfig8(setup, VL6180_SYSTEM_INTERRUPT_CONFIG_GPIO, reg);
+    queueConfig8(setup, VL6180_SYSALS_ANALOGUE_GAIN, 0x40 | gain);
+    queueConfig16(setup, VL6180_SYSALS_INTEGRATION_PERIOD, integrationMs - 1);
     
     // start ALS
-    write8(VL6180_SYSALS_START, 0x1);
+    queue8(setup, VL6180_SYSALS_START, 0x1);
+    
+    this->interruptLine.clear();
+    if (!track(this->transfer(setup)).ok()) {
+        this->shadow.clear();
+    }
     
-    // Poll until "New Sample Ready threshold event" is set
-    while (4 != ((read8(VL6180_RESULT_INTERRUPT_STATUS_GPIO) >> 3) & 0x7));
+    // Wait until "New Sample Ready threshold event" is set
+    waitForRegister(VL6180_RESULT_INTERRUPT_STATUS_GPIO, 0x38, 0x20, alsUs(), alsUs());
     
     // read lux
-    float lux = read16(VL6180_RESULT_ALS_VAL);
+    Vl6180Results results;
+    readResults(results, VL6180_RESULT_ALS_VAL - VL6180_RESULT_RANGE_STATUS + 2);
     
     // clear interrupt
     write8(VL6180_SYSTEM_INTERRUPT_CLEAR, 0x07);
     
-    lux *= 0.32; // calibrated count/lux
-    switch(gain) {
-        case VL6180_ALS_GAIN_1:
-            break;
-        case VL6180_ALS_GAIN_1_25:
-            lux /= 1.25;
-            break;
-        case VL6180_ALS_GAIN_1_67:
-            lux /= 1.76;
-            break;
-        case VL6180_ALS_GAIN_2_5:
-            lux /= 2.5;
-            break;
-        case VL6180_ALS_GAIN_5:
-            lux /= 5;
-            break;
-        case VL6180_ALS_GAIN_10:
-            lux /= 10;
-            break;
-        case VL6180_ALS_GAIN_20: 
-            lux /= 20;
-            break;
-        case VL6180_ALS_GAIN_40: 
-            lux /= 20;
-            break;
+    if (this->lastError) {
+        return false;
     }
-    lux *= 100;
-    lux /= 100; // integration time in ms
     
-    return DataManip::dataToString(lux, 1);
+    counts = results.alsVal;
+    return true;
 }
 
-void Vl6180Drv::loadSettings(void) {
+// Turns automatic selection of the ALS gain and integration period on or off
+void Vl6180Drv::setAlsAutoRange(bool enable) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->alsAutoRange = enable;
+}
+
+// Fixes the ALS gain (one of the VL6180_ALS_GAIN codes) and integration period, and
+// turns off auto ranging. Takes effect at the next single shot ALS measurement, so it is
+// refused while a continuous mode runs with the settings it was started with.
+bool Vl6180Drv::setAlsRange(uint8_t gain, uint16_t integrationMs) {
     
-    // private settings from page 24 of app note
-    write8(0x0207, 0x01);
-    write8(0x0208, 0x01);
-    write8(0x0096, 0x00);
-    write8(0x0097, 0xfd);
-    write8(0x00e3, 0x00);
-    write8(0x00e4, 0x04);
-    write8(0x00e5, 0x02);
-    write8(0x00e6, 0x01);
-    write8(0x00e7, 0x03);
-    write8(0x00f5, 0x02);
-    write8(0x00d9, 0x05);
-    write8(0x00db, 0xce);
-    write8(0x00dc, 0x03);
-    write8(0x00dd, 0xf8);
-    write8(0x009f, 0x00);
-    write8(0x00a3, 0x3c);
-    write8(0x00b7, 0x00);
-    write8(0x00bb, 0x3c);
-    write8(0x00b2, 0x09);
-    write8(0x00ca, 0x09);
-    write8(0x0198, 0x01);
-    write8(0x01b0, 0x17);
-    write8(0x01ad, 0x00);
-    write8(0x00ff, 0x05);
-    write8(0x0100, 0x05);
-    write8(0x0199, 0x05);
-    write8(0x01a6, 0x1b);
-    write8(0x01ac, 0x3e);
-    write8(0x01a7, 0x1f);
-    write8(0x0030, 0x00);
+    if ((gain > VL6180_ALS_GAIN_40) || (integrationMs == 0) || (integrationMs > VL6180_ALS_INTEGRATION_MAX_MS)) {
+        return false;
+    }
     
-    // Recommended : Public registers - From the ST data sheet
+    std::lock_guard<std::mutex> guard(this->lock);
     
-    // Enables polling for 'New Sample ready' when measurement completes
-    write8(VL6180_SYSTEM_MODE_GPIO1, 0x10);
+    if (this->mode != VL6180_MODE_SINGLE_SHOT) {
+        return false;
+    }
     
-    // Set the averaging sample period (compromise between lower noise and
-    // increased execution time)
-    write8(VL6180_READOUT_AVERAGING_SAMPLE_PERIOD, 0x30);
+    this->alsAutoRange = false;
+    this->alsGain = gain;
+    this->alsIntegrationMs = integrationMs;
     
-    // Sets the light and dark gain (upper nibble). Dark gain should not be changed
-    write8(VL6180_SYSALS_ANALOGUE_GAIN, 0x46);
+    return true;
+}
+
+// Chooses the gain and integration period for the next measurement from the raw
+// count of the last one. Nothing changes while the count stays between the low and
+// high bounds, so the settings do not hunt around a boundary. Otherwise the shortest
+// integration period and then the lowest gain which bring the count up to the target
+// are chosen, which keeps the measurement quick and clear of saturation.
+void Vl6180Drv::selectAlsRange(uint16_t counts) {
     
-    // sets the # of range measurements after which auto calibration of
-    // system is performed
-    write8(VL6180_SYSRANGE_VHV_REPEAT_RATE, 0xFF);
+    if ((counts >= VL6180_ALS_AUTO_LOW) && (counts <= VL6180_ALS_AUTO_HIGH)) {
+        return;
+    }
     
-    // Set ALS integration time to 100ms
-    write8(VL6180_SYSALS_INTEGRATION_PERIOD, 0x64);
+    // a saturated count only says the light is at least this bright
+    float effective = (counts == VL6180_ALS_SATURATED) ? (float)counts * 4 : (float)(counts ? counts : 1);
+    float sensitivity = alsGainValue(this->alsGain) * this->alsIntegrationMs;
+    float wanted = sensitivity * VL6180_ALS_AUTO_TARGET / effective;
     
-    // perform a single temperature calibration of the ranging sensor
-    write8(VL6180_SYSRANGE_VHV_RECALIBRATE, 0x01);
+    const size_t numGains = sizeof(alsGains) / sizeof(alsGains[0]);
+    const size_t numPeriods = sizeof(alsPeriods) / sizeof(alsPeriods[0]);
     
-    // Optional: Public registers - See data sheet for more detail
+    for (size_t p = 0; p < numPeriods; p++) {
+        for (size_t g = 0; g < numGains; g++) {
+            if (alsGains[g].gain * alsPeriods[p] >= wanted) {
+                this->alsGain = alsGains[g].code;
+                this->alsIntegrationMs = alsPeriods[p];
+                return;
+            }
+        }
+    }
     
-    // Set default ranging inter-measurement period to 100ms
-    write8(VL6180_SYSRANGE_INTERMEASUREMENT_PERIOD, 0x09);
+    // too dark to reach the target, so use the most sensitive setting
+    this->alsGain = alsGains[numGains - 1].code;
+    this->alsIntegrationMs = alsPeriods[numPeriods - 1];
+}
+
+// Waits until neither a range nor an ALS measurement is running, as one from a continuous
+// mode stopped just before may still be finishing, and the sensor ignores a start until
+// then. Called with lock held.
+bool Vl6180Drv::waitUntilIdle() {
+    return waitForRegister(VL6180_RESULT_RANGE_STATUS, 0x01, 0x01, 0, maximumRangeUs()) &&
+           waitForRegister(VL6180_RESULT_ALS_STATUS, 0x01, 0x01, 0, alsUs());
+}
+
+// Puts the sensor into continuous ranging at the programmed inter-measurement period,
+// with a reader thread collecting each sample into the range buffer
+bool Vl6180Drv::startContinuousRange() {
+    std::lock_guard<std::mutex> guard(this->lock);
     
-    // Set default ALS inter-measurement period to 500ms
-    write8(VL6180_SYSALS_INTERMEASUREMENT_PERIOD, 0x31);
+    if (!this->active || (this->mode != VL6180_MODE_SINGLE_SHOT) || this->rangePending) {
+        return false;
+    }
     
-    // Configures interrupt on 'New Sample Ready threshold event'
-    write8(VL6180_SYSTEM_INTERRUPT_CONFIG_GPIO, 0x24);
+    this->lastError = 0;
     
-    write8(VL6180_SYSRANGE_MAX_CONVERGENCE_TIME, 0x32);
-    write8(VL6180_SYSRANGE_RANGE_CHECK_ENABLES, 0x10 | 0x01);
-    write8(VL6180_SYSRANGE_EARLY_CONVERGENCE_ESTIMATE, 0x7B );
+    if (!waitUntilIdle()) {
+        return false;
+    }
     
-    write8(VL6180_FIRMWARE_RESULT_SCALER,0x01);
-}
-
-uint8_t Vl6180Drv::readRangeStatus(void) {
-    return (read8(VL6180_RESULT_RANGE_STATUS) >> 4);
+    write8(VL6180_SYSTEM_INTERRUPT_CLEAR, 0x07);
+    write8(VL6180_SYSRANGE_START, 0x03);
+    
+    if (this->lastError) {
+        return false;
+    }
+    
+    startReader(VL6180_MODE_CONTINUOUS_RANGE);
+    
+    return true;
 }
 
-uint16_t Vl6180Drv::read16(uint8_t reg) {
-    uint16_t h; uint16_t l;
+// Puts the sensor into interleaved mode, where every continuous ALS measurement is
+// followed by a range measurement, and a reader thread collects them as pairs. Fails if
+// the ALS inter-measurement period is too short to fit the ALS integration period and
+// the longest range measurement, as the sensor would overrun its schedule.
+bool Vl6180Drv::startInterleaved() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    
+    if (!this->active || (this->mode != VL6180_MODE_SINGLE_SHOT) || this->rangePending) {
+        return false;
+    }
+    
+    this->lastError = 0;
+    
+    if ((this->alsIntegrationMs * 1000) + maximumRangeUs() > alsPeriodUs()) {
+        return false;
+    }
+    
+    if (!waitUntilIdle()) {
+        return false;
+    }
+    
+    // new sample ready interrupts for both range and ALS
+    writeConfig8(VL6180_SYSTEM_INTERRUPT_CONFIG_GPIO, 0x24);
+    writeConfig8(VL6180_SYSALS_ANALOGUE_GAIN, 0x40 | this->alsGain);
+    writeConfig16(VL6180_SYSALS_INTEGRATION_PERIOD, this->alsIntegrationMs - 1);
+    write8(VL6180_SYSTEM_INTERRUPT_CLEAR, 0x07);
+    writeConfig8(VL6180_INTERLEAVED_MODE_ENABLE, 0x01);
+    write8(VL6180_SYSALS_START, 0x03);
+    
+    if (this->lastError) {
+        return false;
+    }
     
-    l = read8(reg);
-    h = read8(reg+1);
+    startReader(VL6180_MODE_INTERLEAVED);
     
-    return ((short)h<<8)|(short)l;
+    return true;
 }
 
-// seems that for this device, we need to split the 16-bit register in two,
-// so the usual writeRegister does not work, hence this method
-void Vl6180Drv::write8(uint16_t reg, unsigned char data) {
-    unsigned char data_write[3];
-    data_write[0] = (reg >> 8) & 0xFF;; // MSB of register address
-    data_write[1] = reg & 0xFF; // LSB of register address
-    data_write[2] = data & 0xFF;
+// Puts the sensor into continuous ranging with the history buffer recording each result,
+// so the reader thread only needs to wake once every few samples to collect a batch
+bool Vl6180Drv::startRangeHistory() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    
+    if (!this->active || (this->mode != VL6180_MODE_SINGLE_SHOT) || this->rangePending) {
+        return false;
+    }
     
-    ::write(this->file, data_write, 3);
+    this->lastError = 0;
+    
+    if (!waitUntilIdle()) {
+        return false;
+    }
+    
+    // clear the buffer and record range results
+    write8(VL6180_SYSTEM_HISTORY_CTRL, 0x05);
+    write8(VL6180_SYSTEM_INTERRUPT_CLEAR, 0x07);
+    write8(VL6180_SYSRANGE_START, 0x03);
+    
+    if (this->lastError) {
+        return false;
+    }
+    
+    // the cleared buffer reads as zeros until it fills
+    memset(this->historyRanges, 0, sizeof(this->historyRanges));
+    this->lastHistoryFetch = now();
+    startReader(VL6180_MODE_RANGE_HISTORY);
+    
+    return true;
 }
 
-// seems that for this device, we need to split the 16-bit register in two,
-// so the usual readRegister does not work, hence this method
-unsigned char Vl6180Drv::read8(uint16_t reg) {
-    unsigned char data_write[2];
-    unsigned char data_read[1];
-    data_write[0] = (reg >> 8) & 0xFF; // MSB of register address
-    data_write[1] = reg & 0xFF; // LSB of register address
+// Runs continuous ranging with the interrupt source set to a threshold, so that only
+// ranges below low, above high, or outside the window between them are collected
+bool Vl6180Drv::startRangeEvents(Vl6180Threshold threshold, uint8_t low, uint8_t high) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    
+    if (!this->active || (this->mode != VL6180_MODE_SINGLE_SHOT) || this->rangePending) {
+        return false;
+    }
+    
+    this->lastError = 0;
+    
+    if (!waitUntilIdle()) {
+        return false;
+    }
     
-    ::write(this->file, data_write, 2);
-    ::read(this->file, data_read, 1);
+    writeConfig8(VL6180_SYSRANGE_THRESH_LOW, low);
+    writeConfig8(VL6180_SYSRANGE_THRESH_HIGH, high);
+    writeConfig8(VL6180_SYSTEM_INTERRUPT_CONFIG_GPIO, threshold);
+    write8(VL6180_SYSTEM_INTERRUPT_CLEAR, 0x07);
+    write8(VL6180_SYSRANGE_START, 0x03);
+    
+    if (this->lastError) {
+        return false;
+    }
     
-    return data_read[0];
+    startReader(VL6180_MODE_RANGE_EVENTS);
+    
+    return true;
 }
 
+// Runs continuous ALS with the interrupt source set to a threshold in lux. The thresholds
+// are converted to counts at the current gain and integration period, which stay fixed
+// while the events run.
+bool Vl6180Drv::startAlsEvents(Vl6180Threshold threshold, float low, float high) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    
+    if (!this->active || (this->mode != VL6180_MODE_SINGLE_SHOT) || this->rangePending) {
+        return false;
+    }
+    
+    this->lastError = 0;
+    
+    if (!waitUntilIdle()) {
+        return false;
+    }
+    
+    uint16_t lowCounts = luxToCounts(low, this->alsGain, this->alsIntegrationMs);
+    uint16_t highCounts = luxToCounts(high, this->alsGain, this->alsIntegrationMs);
+    
+    writeConfig8(VL6180_SYSALS_ANALOGUE_GAIN, 0x40 | this->alsGain);
+    writeConfig16(VL6180_SYSALS_INTEGRATION_PERIOD, this->alsIntegrationMs - 1);
+    writeConfig8(VL6180_SYSALS_THRESH_LOW, lowCounts >> 8);
+    writeConfig8(VL6180_SYSALS_THRESH_LOW + 1, lowCounts & 0xFF);
+    writeConfig8(VL6180_SYSALS_THRESH_HIGH, highCounts >> 8);
+    writeConfig8(VL6180_SYSALS_THRESH_HIGH + 1, highCounts & 0xFF);
+    writeConfig8(VL6180_SYSTEM_INTERRUPT_CONFIG_GPIO, threshold << 3);
+    write8(VL6180_SYSTEM_INTERRUPT_CLEAR, 0x07);
+    write8(VL6180_SYSALS_START, 0x03);
+    
+    if (this->lastError) {
+        return false;
+    }
+    
+    startReader(VL6180_MODE_ALS_EVENTS);
+    
+    return true;
+}
+
+// Called with lock held once the sensor is running in the given mode
+void Vl6180Drv::startReader(Vl6180Mode mode) {
+    this->mode = mode;
+    this->stopReader = false;
+    this->reader = std::thread(&Vl6180Drv::readContinuous, this);
+}
+
+// Stops any continuous mode and returns the sensor to single shot measurements
+void Vl6180Drv::stopContinuous() {
+    {
+        std::lock_guard<std::mutex> guard(this->readerLock);
+        this->stopReader = true;
+    }
+    this->readerWake.notify_all();
+    
+    if (this->reader.joinable()) {
+        this->reader.join();
+    }
+    
+    std::lock_guard<std::mutex> guard(this->lock);
+    
+    if (this->mode == VL6180_MODE_SINGLE_SHOT) {
+        return;
+    }
+    
+    // writing the start bit again stops a continuous measurement
+    this->lastError = 0;
+    if (this->mode == VL6180_MODE_INTERLEAVED) {
+        write8(VL6180_SYSALS_START, 0x01);
+        writeConfig8(VL6180_INTERLEAVED_MODE_ENABLE, 0x00);
+    }
+    else if (this->mode == VL6180_MODE_ALS_EVENTS) {
+        write8(VL6180_SYSALS_START, 0x01);
+    }
+    else {
+        write8(VL6180_SYSRANGE_START, 0x01);
+    }
+    if (this->mode == VL6180_MODE_RANGE_HISTORY) {
+        write8(VL6180_SYSTEM_HISTORY_CTRL, 0x00);
+    }
+    
+    // back to new sample ready interrupts after an event mode
+    writeConfig8(VL6180_SYSTEM_INTERRUPT_CONFIG_GPIO, 0x24);
+    write8(VL6180_SYSTEM_INTERRUPT_CLEAR, 0x07);
+    
+    this->mode = VL6180_MODE_SINGLE_SHOT;
+}
+
+Vl6180Mode Vl6180Drv::getMode() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->mode;
+}
+
+// Copies the newest sample collected in a continuous mode, without removing anything
+// from the buffer. Returns false if nothing has been collected yet.
+bool Vl6180Drv::latestRange(RangeSample &sample) {
+    std::lock_guard<std::mutex> guard(this->latestLock);
+    if (!this->haveLatest) {
+        return false;
+    }
+    sample = this->latest;
+    return true;
+}
+
+// Moves up to max of the oldest buffered samples into the array, returning how many.
+// Only one thread at a time may drain the buffer.
+size_t Vl6180Drv::drainRanges(RangeSample *samples, size_t max) {
+    return this->ranges.drain(samples, max);
+}
+
+// Copies the newest pair collected in interleaved mode. Returns false if nothing has
+// been collected yet.
+bool Vl6180Drv::latestInterleaved(InterleavedSample &sample) {
+    std::lock_guard<std::mutex> guard(this->latestLock);
+    if (!this->haveLatestPair) {
+        return false;
+    }
+    sample = this->latestPair;
+    return true;
+}
+
+// Moves up to max of the oldest buffered pairs into the array, returning how many.
+// Only one thread at a time may drain the buffer.
+size_t Vl6180Drv::drainInterleaved(InterleavedSample *samples, size_t max) {
+    return this->pairs.drain(samples, max);
+}
+
+// Copies the newest event collected in an event mode. Returns false if nothing has
+// been collected yet.
+bool Vl6180Drv::latestEvent(ThresholdEvent &event) {
+    std::lock_guard<std::mutex> guard(this->latestLock);
+    if (!this->haveLastEvent) {
+        return false;
+    }
+    event = this->lastEvent;
+    return true;
+}
+
+// Moves up to max of the oldest buffered events into the array, returning how many.
+// Only one thread at a time may drain the buffer.
+size_t Vl6180Drv::drainEvents(ThresholdEvent *events, size_t max) {
+    return this->events.drain(events, max);
+}
+
+// Number of samples and threshold events discarded because a buffer was full when they arrived
+size_t Vl6180Drv::getDroppedSamples() {
+    return this->ranges.getDropped() + this->pairs.getDropped() + this->events.getDropped();
+}
+
+void Vl6180Drv::readContinuous() {
+    std::unique_lock<std::mutex> wait(this->readerLock);
+    
+    while (!this->stopReader) {
+        wait.unlock();
+        
+        // threshold events are rare and stay latched until cleared, so the status is only
+        // read once the sensor signals an edge, the wait being capped only so a stop is
+        // noticed. Without the line it is looked at every several periods.
+        if ((this->mode == VL6180_MODE_RANGE_EVENTS) || (this->mode == VL6180_MODE_ALS_EVENTS)) {
+            uint32_t periodUs;
+            
+            if (this->interruptLine.isOpen()) {
+                if (this->interruptLine.wait(VL6180_INTERRUPT_WAIT_US) != 0) {
+                    std::lock_guard<std::mutex> guard(this->lock);
+                    collectEvent();
+                }
+                wait.lock();
+                continue;
+            }
+            
+            {
+                std::lock_guard<std::mutex> guard(this->lock);
+                collectEvent();
+                periodUs = (this->mode == VL6180_MODE_ALS_EVENTS) ? alsPeriodUs() : rangePeriodUs();
+            }
+            
+            wait.lock();
+            this->readerWake.wait_for(wait, std::chrono::microseconds((uint64_t)periodUs * VL6180_EVENT_POLL_PERIODS));
+            continue;
+        }
+        
+        bool fresh = false;
+        uint32_t periodUs;
+        {
+            std::lock_guard<std::mutex> guard(this->lock);
+            if (this->mode == VL6180_MODE_INTERLEAVED) {
+                fresh = collectInterleaved();
+                periodUs = alsPeriodUs();
+            }
+            else if (this->mode == VL6180_MODE_RANGE_HISTORY) {
+                collectRangeHistory();
+                periodUs = rangePeriodUs();
+            }
+            else {
+                fresh = collectContinuousRange();
+                periodUs = rangePeriodUs();
+            }
+        }
+        
+        // the history buffer is emptied in batches, leaving headroom before it would wrap
+        if (this->mode == VL6180_MODE_RANGE_HISTORY) {
+            wait.lock();
+            this->readerWake.wait_for(wait, std::chrono::microseconds(periodUs * VL6180_HISTORY_BATCH));
+            continue;
+        }
+        
+        // with the interrupt wired, sleep until the sensor signals the next sample, waking
+        // regularly to notice a stop
+        if (this->interruptLine.isOpen()) {
+            this->interruptLine.wait((periodUs < VL6180_INTERRUPT_WAIT_US) ? periodUs : VL6180_INTERRUPT_WAIT_US);
+            wait.lock();
+            continue;
+        }
+        
+        // after a sample the next one is most of a period away, otherwise look again soon
+        uint32_t sleepUs = fresh ? (periodUs * 3 / 4) : (periodUs / 16);
+        if (sleepUs < 1000) {
+            sleepUs = 1000;
+        }
+        
+        wait.lock();
+        this->readerWake.wait_for(wait, std::chrono::microseconds(sleepUs));
+    }
+}
+
+// Waits until (reg & mask) == expected. The thread first sleeps for the shortest time
+// the operation can take, then checks at increasing intervals, or sleeps on the GPIO1
+// edge when waiting on the interrupt status with an interrupt line. Gives up with
+// ETIMEDOUT once the deadline passes. Called with lock held.
+bool Vl6180Drv::waitForRegister(uint16_t reg, uint8_t mask, uint8_t expected, uint32_t minimumUs, uint32_t expectedUs) {
+    uint64_t start = now();
+    uint64_t deadline = start + measurementDeadlineUs(expectedUs);
+    bool edges = this->interruptLine.isOpen() && (reg == VL6180_RESULT_INTERRUPT_STATUS_GPIO);
+    uint32_t intervalUs = VL6180_POLL_INITIAL_US;
+    
+    if (minimumUs) {
+        std::this_thread::sleep_for(std::chrono::microseconds(minimumUs));
+    }
+    
+    while (true) {
+        unsigned char value = read8(reg);
+        
+        if (this->lastError) {
+            return false;
+        }
+        if ((value & mask) == expected) {
+            return true;
+        }
+        
+        uint64_t current = now();
+        if (current >= deadline) {
+            track(timedOut());
+            return false;
+        }
+        
+        uint64_t remaining = deadline - current;
+        
+        // a timeout just means looking at the register again, in case an edge was missed
+        if (edges) {
+            this->interruptLine.wait((remaining < VL6180_INTERRUPT_WAIT_US) ? remaining : VL6180_INTERRUPT_WAIT_US);
+            continue;
+        }
+        
+        std::this_thread::sleep_for(std::chrono::microseconds((remaining < intervalUs) ? remaining : intervalUs));
+        
+        if (intervalUs < VL6180_POLL_MAXIMUM_US) {
+            intervalUs *= 2;
+        }
+    }
+}
+
+// Longest a measurement may take before it is abandoned: the configured timeout, or by
+// default twice the expected time plus a margin for bus delays
+uint32_t Vl6180Drv::measurementDeadlineUs(uint32_t expectedUs) {
+    if (this->measurementTimeoutUs) {
+        return this->measurementTimeoutUs;
+    }
+    return (expectedUs * 2) + VL6180_POLL_MARGIN_US;
+}
+
+i2cbus::I2CResult Vl6180Drv::timedOut() {
+    i2cbus::I2CResult result;
+    result.error = ETIMEDOUT;
+    return result;
+}
+
+// Sets a fixed limit on how long any single wait for the sensor may take, or 0 to
+// derive the limit from the programmed conversion times
+void Vl6180Drv::setMeasurementTimeout(uint32_t timeoutUs) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->measurementTimeoutUs = timeoutUs;
+}
+
+// Readout averaging time, 1.3ms plus 64.5us per READOUT_AVERAGING_SAMPLE_PERIOD step
+uint32_t Vl6180Drv::averagingUs() {
+    return 1300 + (readConfig8(VL6180_READOUT_AVERAGING_SAMPLE_PERIOD) * 645) / 10;
+}
+
+// Shortest range measurement: pre-calibration and readout averaging with instant convergence
+uint32_t Vl6180Drv::minimumRangeUs() {
+    return VL6180_RANGE_PRECAL_US + averagingUs();
+}
+
+// Longest range measurement: convergence runs for the whole SYSRANGE_MAX_CONVERGENCE_TIME
+uint32_t Vl6180Drv::maximumRangeUs() {
+    return minimumRangeUs() + (readConfig8(VL6180_SYSRANGE_MAX_CONVERGENCE_TIME) * 1000);
+}
+
+// ALS measurement time, SYSALS_INTEGRATION_PERIOD counts in ms less one
+uint32_t Vl6180Drv::alsUs() {
+    return ((readConfig16(VL6180_SYSALS_INTEGRATION_PERIOD) & 0x1FF) + 1) * 1000;
+}
+
+// Uses the GPIO1 interrupt output, wired to a line of a GPIO character device, to wait
+// for measurements instead of polling. loadSettings configures GPIO1 as an active low
+// new sample interrupt. Returns false, leaving polling in place, if the line is unavailable.
+bool Vl6180Drv::setInterruptLine(const std::string &chip, uint32_t offset) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    
+    if (this->mode != VL6180_MODE_SINGLE_SHOT) {
+        return false;
+    }
+    
+    return this->interruptLine.requestEvents(chip, offset, true) == 0;
+}
+
+// Returns to polling for measurement completion
+void Vl6180Drv::clearInterruptLine() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    
+    if (this->mode == VL6180_MODE_SINGLE_SHOT) {
+        this->interruptLine.release();
+    }
+}
+
+// Collects a completed range sample if the sensor has one. Called with lock held.
+bool Vl6180Drv::collectContinuousRange() {
+    this->lastError = 0;
+    
+    unsigned char status = read8(VL6180_RESULT_INTERRUPT_STATUS_GPIO);
+    if (this->lastError || ((status & 0x07) != 0x04)) {
+        return false;
+    }
+    
+    Vl6180Results results;
+    readResults(results);
+    write8(VL6180_SYSTEM_INTERRUPT_CLEAR, 0x01);
+    
+    if (this->lastError) {
+        return false;
+    }
+    
+    RangeSample sample;
+    decodeRange(results, sample);
+    sample.timestamp = now();
+    
+    this->ranges.push(sample);
+    
+    std::lock_guard<std::mutex> guard(this->latestLock);
+    this->latest = sample;
+    this->haveLatest = true;
+    
+    return true;
+}
+
+// Collects a completed range and ALS pair if the sensor has both. Called with lock held.
+bool Vl6180Drv::collectInterleaved() {
+    this->lastError = 0;
+    
+    unsigned char status = read8(VL6180_RESULT_INTERRUPT_STATUS_GPIO);
+    if (this->lastError || ((status & 0x07) != 0x04) || (((status >> 3) & 0x07) != 0x04)) {
+        return false;
+    }
+    
+    // the ALS value and range value are both in the front of the result window
+    Vl6180Results results;
+    readResults(results, VL6180_RESULT_RANGE_VAL - VL6180_RESULT_RANGE_STATUS + 1);
+    write8(VL6180_SYSTEM_INTERRUPT_CLEAR, 0x03);
+    
+    if (this->lastError) {
+        return false;
+    }
+    
+    InterleavedSample sample;
+    sample.range = results.rangeVal;
+    sample.rangeValid = ((results.rangeStatus >> 4) == VL6180_ERROR_NONE);
+    sample.lux = countsToLux(results.alsVal, this->alsGain, this->alsIntegrationMs);
+    sample.alsCounts = results.alsVal;
+    sample.alsValid = (results.alsVal != VL6180_ALS_SATURATED);
+    sample.timestamp = now();
+    
+    this->pairs.push(sample);
+    
+    std::lock_guard<std::mutex> guard(this->latestLock);
+    this->latestPair = sample;
+    this->haveLatestPair = true;
+    
+    return true;
+}
+
+// Collects a threshold event if the sensor has raised one. The sensor measures
+// continuously, but only measurements which cross a threshold are read out.
+// Called with lock held.
+bool Vl6180Drv::collectEvent() {
+    this->lastError = 0;
+    
+    bool als = (this->mode == VL6180_MODE_ALS_EVENTS);
+    
+    unsigned char status = read8(VL6180_RESULT_INTERRUPT_STATUS_GPIO);
+    uint8_t code = als ? ((status >> 3) & 0x07) : (status & 0x07);
+    if (this->lastError || (code == 0)) {
+        return false;
+    }
+    
+    Vl6180Results results;
+    readResults(results, VL6180_RESULT_RANGE_VAL - VL6180_RESULT_RANGE_STATUS + 1);
+    write8(VL6180_SYSTEM_INTERRUPT_CLEAR, als ? 0x02 : 0x01);
+    
+    if (this->lastError) {
+        return false;
+    }
+    
+    ThresholdEvent event;
+    event.code = code;
+    event.range = als ? 0 : results.rangeVal;
+    event.lux = als ? countsToLux(results.alsVal, this->alsGain, this->alsIntegrationMs) : 0;
+    event.timestamp = now();
+    
+    this->events.push(event);
+    
+    std::lock_guard<std::mutex> guard(this->latestLock);
+    this->lastEvent = event;
+    this->haveLastEvent = true;
+    
+    return true;
+}
+
+// Collects the range results recorded in the history buffer since the last fetch, in one
+// burst. The buffer holds no count, so the number of new results is found by matching the
+// buffer against the one read at the previous fetch: with k new results, the older entries
+// are the previous newest ones moved back by k. Repeated values can make several counts
+// match, so the one nearest the count expected from the inter-measurement period is taken.
+// Called with lock held.
+size_t Vl6180Drv::collectRangeHistory() {
+    this->lastError = 0;
+    
+    // the history buffer ends just before the range value, so one burst covers both
+    Vl6180Results results;
+    readResults(results, VL6180_RESULT_RANGE_VAL - VL6180_RESULT_RANGE_STATUS + 1);
+    write8(VL6180_SYSTEM_INTERRUPT_CLEAR, 0x01);
+    
+    if (this->lastError) {
+        return 0;
+    }
+    
+    // range i back is in history register i / 2, the high byte holding the newer of the pair
+    uint8_t history[VL6180_RESULT_HISTORY_RANGES];
+    for (int i = 0; i < VL6180_RESULT_HISTORY_RANGES; i++) {
+        history[i] = (results.history[i / 2] >> ((i % 2) ? 0 : 8)) & 0xFF;
+    }
+    
+    uint64_t fetched = now();
+    uint32_t periodUs = rangePeriodUs();
+    uint64_t expected = ((fetched - this->lastHistoryFetch) + (periodUs / 2)) / periodUs;
+    
+    // a full buffer of new results always matches, older ones having been overwritten
+    uint64_t count = VL6180_RESULT_HISTORY_RANGES;
+    for (uint64_t k = 0; k < VL6180_RESULT_HISTORY_RANGES; k++) {
+        if (memcmp(history + k, this->historyRanges, VL6180_RESULT_HISTORY_RANGES - k) != 0) {
+            continue;
+        }
+        
+        uint64_t distance = (k > expected) ? (k - expected) : (expected - k);
+        uint64_t best = (count > expected) ? (count - expected) : (expected - count);
+        if (distance < best) {
+            count = k;
+        }
+    }
+    
+    memcpy(this->historyRanges, history, sizeof(history));
+    this->lastHistoryFetch = fetched;
+    
+    if (count == 0) {
+        return 0;
+    }
+    
+    // The buffer keeps no error codes or diagnostics, so only the 255 overflow reading is
+    // marked invalid
+    RangeSample sample;
+    memset(&sample, 0, sizeof(sample));
+    for (int i = count - 1; i >= 0; i--) {
+        sample.range = history[i];
+        sample.error = VL6180_ERROR_NONE;
+        sample.valid = (sample.range != 0xFF);
+        sample.timestamp = fetched - (i * periodUs);
+        this->ranges.push(sample);
+    }
+    
+    std::lock_guard<std::mutex> guard(this->latestLock);
+    this->latest = sample;
+    this->haveLatest = true;
+    
+    return count;
+}
+
+// Continuous ranging period, SYSRANGE_INTERMEASUREMENT_PERIOD counts in 10ms steps
+uint32_t Vl6180Drv::rangePeriodUs() {
+    return (readConfig8(VL6180_SYSRANGE_INTERMEASUREMENT_PERIOD) + 1) * 10000;
+}
+
+// Moves the sensor to a new I2C address, which it keeps until it is reset or powered down
+bool Vl6180Drv::setAddress(uint8_t addr) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    
+    if (!this->active || (this->mode != VL6180_MODE_SINGLE_SHOT) || (addr == 0) || (addr > 0x7F)) {
+        return false;
+    }
+    
+    this->lastError = 0;
+    
+    write8(VL6180_I2C_SLAVE_DEVICE_ADDRESS, addr);
+    if (this->lastError) {
+        return false;
+    }
+    
+    this->setAddr(addr);
+    
+    // the sensor answers at once on the new address
+    return (read8(VL6180_IDENTIFICATION_MODEL_ID) == 0xB4) && (this->lastError == 0);
+}
+
+// Gives each sensor on a bus its own address. Every sensor is held in shutdown, then they
+// are released one at a time, each answering at the default address until it is moved.
+// Only the last sensor may stay at the default address, as any released after it would
+// answer there too. The shutdown lines are returned in lines, and have to be kept for the
+// sensors to stay up. Returns 0, or the errno of the first failure with every line released.
+int Vl6180Drv::assignAddresses(const std::string &devfile, const std::vector<Vl6180Slot> &slots, std::vector<std::unique_ptr<GpioLine>> &lines) {
+    
+    std::shared_ptr<i2cbus::I2CBus> bus = i2cbus::I2CBus::acquire(devfile);
+    if (!bus) {
+        return ENODEV;
+    }
+    
+    return assignAddresses(bus, slots, lines);
+}
+
+int Vl6180Drv::assignAddresses(std::shared_ptr<i2cbus::I2CTransport> transport, const std::vector<Vl6180Slot> &slots, std::vector<std::unique_ptr<GpioLine>> &lines) {
+    
+    // lines from any earlier assignment are released, and the new ones are only handed
+    // over once every sensor has moved, so a failure leaves none held
+    lines.clear();
+    std::vector<std::unique_ptr<GpioLine>> held;
+    
+    for (size_t i = 0; i + 1 < slots.size(); i++) {
+        if (slots[i].addr == VL6180_DEFAULT_I2C_ADDR) {
+            return EINVAL;
+        }
+    }
+    
+    // shutdown is active low, and also clears any address given before
+    for (size_t i = 0; i < slots.size(); i++) {
+        std::unique_ptr<GpioLine> line(new GpioLine());
+        int error = line->requestOutput(slots[i].chip, slots[i].offset, false);
+        if (error) {
+            return error;
+        }
+        held.push_back(std::move(line));
+    }
+    
+    std::this_thread::sleep_for(std::chrono::microseconds(VL6180_SHUTDOWN_HOLD_US));
+    
+    for (size_t i = 0; i < slots.size(); i++) {
+        int error = held[i]->setValue(true);
+        if (error) {
+            return error;
+        }
+        
+        std::this_thread::sleep_for(std::chrono::microseconds(VL6180_BOOT_US));
+        
+        if (slots[i].addr == VL6180_DEFAULT_I2C_ADDR) {
+            continue;
+        }
+        
+        error = moveAddress(transport, VL6180_DEFAULT_I2C_ADDR, slots[i].addr);
+        if (error) {
+            std::cerr << name << " at shutdown line " << slots[i].offset << " could not be moved to address " << (int)slots[i].addr << std::endl;
+            return error;
+        }
+    }
+    
+    lines.swap(held);
+    
+    return 0;
+}
 
-
-
+// Moves the sensor answering at one address to another, before any driver is attached,
+// and checks that it answers there. Returns 0, or an errno value.
+int Vl6180Drv::moveAddress(std::shared_ptr<i2cbus::I2CTransport> transport, uint8_t from, uint8_t to) {
+    
+    if ((to == 0) || (to > 0x7F)) {
+        return EINVAL;
+    }
+    
+    i2cbus::I2CDevice device(transport, from);
+    
+    unsigned char move[3];
+    move[0] = (VL6180_I2C_SLAVE_DEVICE_ADDRESS >> 8) & 0xFF;
+    move[1] = VL6180_I2C_SLAVE_DEVICE_ADDRESS & 0xFF;
+    move[2] = to;
+    
+    i2cbus::I2CResult result = device.write(move, 3);
+    if (!result.ok()) {
+        return result.error;
+    }
+    
+    device.setAddr(to);
+    
+    unsigned char reg[2] = { (VL6180_IDENTIFICATION_MODEL_ID >> 8) & 0xFF, VL6180_IDENTIFICATION_MODEL_ID & 0xFF };
+    unsigned char model = 0;
+    
+    result = device.writeRead(reg, 2, &model, 1);
+    if (!result.ok()) {
+        return result.error;
+    }
+    
+    return (model == 0xB4) ? 0 : ENODEV;
+}
+
+// Reprograms the measurement timing from one of the named profiles
+bool Vl6180Drv::setTimingProfile(Vl6180TimingProfile profile) {
+    
+    if ((profile < VL6180_TIMING_MAX_RATE) || (profile >= VL6180_TIMING_CUSTOM)) {
+        return false;
+    }
+    
+    return applyTiming(timingProfiles[profile], profile);
+}
+
+// Reprograms the measurement timing from a profile name: max-rate, balanced or low-noise
+bool Vl6180Drv::setTimingProfile(const std::string &name) {
+    
+    for (int profile = VL6180_TIMING_MAX_RATE; profile < VL6180_TIMING_CUSTOM; profile++) {
+        if (name == timingNames[profile]) {
+            return setTimingProfile((Vl6180TimingProfile)profile);
+        }
+    }
+    
+    return false;
+}
+
+// Reprograms the measurement timing with custom values
+bool Vl6180Drv::setTiming(const Vl6180Timing &timing) {
+    return applyTiming(timing, VL6180_TIMING_CUSTOM);
+}
+
+Vl6180Timing Vl6180Drv::getTiming() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->timing;
+}
+
+Vl6180TimingProfile Vl6180Drv::getTimingProfile() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->timingProfile;
+}
+
+std::string Vl6180Drv::getTimingProfileName() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    return timingNames[this->timingProfile];
+}
+
+// Conversion times and periods predicted from the timing the device holds
+Vl6180Latency Vl6180Drv::getPredictedLatency() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    
+    Vl6180Latency latency;
+    latency.rangeMinimumUs = minimumRangeUs();
+    latency.rangeMaximumUs = maximumRangeUs();
+    latency.alsUs = alsUs();
+    latency.rangePeriodUs = rangePeriodUs();
+    latency.alsPeriodUs = alsPeriodUs();
+    
+    return latency;
+}
+
+// Checks the timing and sends it to the device in one transaction. The sensor has to be
+// stopped, and the range period has to cover the longest range measurement.
+bool Vl6180Drv::applyTiming(const Vl6180Timing &timing, Vl6180TimingProfile profile) {
+    
+    if ((timing.convergenceMs < 1) || (timing.convergenceMs > 63)) {
+        return false;
+    }
+    
+    uint32_t longestUs = VL6180_RANGE_PRECAL_US + 1300 + (timing.averagingPeriod * 645) / 10 + (timing.convergenceMs * 1000);
+    if ((uint32_t)(timing.rangePeriod + 1) * 10000 < longestUs) {
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> guard(this->lock);
+    
+    if (!this->active || (this->mode != VL6180_MODE_SINGLE_SHOT) || this->rangePending) {
+        return false;
+    }
+    
+    this->lastError = 0;
+    
+    i2cbus::I2CTransaction settings;
+    queueTiming(settings, timing);
+    
+    if (!track(this->transfer(settings)).ok()) {
+        this->shadow.clear();
+        return false;
+    }
+    
+    this->timing = timing;
+    this->timingProfile = profile;
+    
+    return true;
+}
+
+// Queues the timing registers, leaving out any the device already holds
+void Vl6180Drv::queueTiming(i2cbus::I2CTransaction &transaction, const Vl6180Timing &timing) {
+    
+    // range convergence limit in ms, which bounds the range for dark targets
+    queueConfig8(transaction, VL6180_SYSRANGE_MAX_CONVERGENCE_TIME, timing.convergenceMs);
+    
+    // averaging sample period (compromise between lower noise and increased execution time)
+    queueConfig8(transaction, VL6180_READOUT_AVERAGING_SAMPLE_PERIOD, timing.averagingPeriod);
+    
+    // the # of range measurements after which auto calibration of system is performed
+    queueConfig8(transaction, VL6180_SYSRANGE_VHV_REPEAT_RATE, timing.vhvRepeatRate);
+    
+    queueConfig8(transaction, VL6180_SYSRANGE_EARLY_CONVERGENCE_ESTIMATE, timing.earlyConvergence);
+    queueConfig8(transaction, VL6180_SYSRANGE_INTERMEASUREMENT_PERIOD, timing.rangePeriod);
+    queueConfig8(transaction, VL6180_SYSALS_INTERMEASUREMENT_PERIOD, timing.alsPeriod);
+}
+
+// Continuous ALS and interleaved period, SYSALS_INTERMEASUREMENT_PERIOD counts in 10ms steps
+uint32_t Vl6180Drv::alsPeriodUs() {
+    return (readConfig8(VL6180_SYSALS_INTERMEASUREMENT_PERIOD) + 1) * 10000;
+}
+
+uint64_t Vl6180Drv::now() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Converts an ALS count to lux for the analogue gain it was measured with
+float Vl6180Drv::countsToLux(uint16_t counts, uint8_t gain, uint16_t integrationMs) {
+    
+    float lux = counts * 0.32; // calibrated count/lux
+    lux /= alsGainValue(gain);
+    lux *= 100;
+    lux /= (integrationMs ? integrationMs : 1); // integration time in ms
+    
+    return lux;
+}
+
+// The raw ALS count which reads as lux, saturating at the largest count
+uint16_t Vl6180Drv::luxToCounts(float lux, uint8_t gain, uint16_t integrationMs) {
+    
+    float counts = (lux / 0.32) * alsGainValue(gain) * integrationMs / 100;
+    if (counts <= 0) {
+        return 0;
+    }
+    
+    return (counts > 0xFFFF) ? 0xFFFF : (uint16_t)counts;
+}
+
+// The analog gain for a VL6180_ALS_GAIN code
+float Vl6180Drv::alsGainValue(uint8_t gain) {
+    
+    for (size_t g = 0; g < sizeof(alsGains) / sizeof(alsGains[0]); g++) {
+        if (alsGains[g].code == (gain & 0x07)) {
+            return alsGains[g].gain;
+        }
+    }
+    
+    return 1;
+}
+
+void Vl6180Drv::loadSettings(void) {
+    
+    // all of the settings are queued and sent to the device together, and every
+    // value except the self clearing recalibrate trigger is kept in the shadow
+    i2cbus::I2CTransaction settings;
+    this->shadow.clear();
+    
+    // private settings from page 24 of app note
+    queueConfig8(settings, 0x0207, 0x01);
+    queueConfig8(settings, 0x0208, 0x01);
+    queueConfig8(settings, 0x0096, 0x00);
+    queueConfig8(settings, 0x0097, 0xfd);
+    queueConfig8(settings, 0x00e3, 0x00);
+    queueConfig8(settings, 0x00e4, 0x04);
+    queueConfig8(settings, 0x00e5, 0x02);
+    queueConfig8(settings, 0x00e6, 0x01);
+    queueConfig8(settings, 0x00e7, 0x03);
+    queueConfig8(settings, 0x00f5, 0x02);
+    queueConfig8(settings, 0x00d9, 0x05);
+    queueConfig8(settings, 0x00db, 0xce);
+    queueConfig8(settings, 0x00dc, 0x03);
+    queueConfig8(settings, 0x00dd, 0xf8);
+    queueConfig8(settings, 0x009f, 0x00);
+    queueConfig8(settings, 0x00a3, 0x3c);
+    queueConfig8(settings, 0x00b7, 0x00);
+    queueConfig8(settings, 0x00bb, 0x3c);
+    queueConfig8(settings, 0x00b2, 0x09);
+    queueConfig8(settings, 0x00ca, 0x09);
+    queueConfig8(settings, 0x0198, 0x01);
+    queueConfig8(settings, 0x01b0, 0x17);
+    queueConfig8(settings, 0x01ad, 0x00);
+    queueConfig8(settings, 0x00ff, 0x05);
+    queueConfig8(settings, 0x0100, 0x05);
+    queueConfig8(settings, 0x0199, 0x05);
+    queueConfig8(settings, 0x01a6, 0x1b);
+    queueConfig8(settings, 0x01ac, 0x3e);
+    queueConfig8(settings, 0x01a7, 0x1f);
+    queueConfig8(settings, 0x0030, 0x00);
+    
+    // Recommended : Public registers - From the ST data sheet
+    
+    // Enables polling for 'New Sample ready' when measurement completes
+    queueConfig8(settings, VL6180_SYSTEM_MODE_GPIO1, 0x10);
+    
+    // Sets the light and dark gain (upper nibble). Dark gain should not be changed
+    queueConfig8(settings, VL6180_SYSALS_ANALOGUE_GAIN, 0x46);
+    
+    // Set ALS integration time to 100ms
+    queueConfig16(settings, VL6180_SYSALS_INTEGRATION_PERIOD, 100 - 1);
+    
+    // perform a single temperature calibration of the ranging sensor
+    queue8(settings, VL6180_SYSRANGE_VHV_RECALIBRATE, 0x01);
+    
+    // Optional: Public registers - See data sheet for more detail
+    
+    // Convergence, averaging, recalibration and inter-measurement periods from the
+    // timing profile, 100ms ranging and 500ms ALS periods unless one has been chosen
+    queueTiming(settings, this->timing);
+    
+    // Configures interrupt on 'New Sample Ready threshold event'
+    queueConfig8(settings, VL6180_SYSTEM_INTERRUPT_CONFIG_GPIO, 0x24);
+    
+    queueConfig8(settings, VL6180_SYSRANGE_RANGE_CHECK_ENABLES, 0x10 | 0x01);
+    
+    queueConfig8(settings, VL6180_FIRMWARE_RESULT_SCALER, 0x01);
+    
+    if (!track(this->transfer(settings)).ok()) {
+        this->shadow.clear();
+    }
+}
+
+// Fills the range, error code and diagnostics of a sample from the result window
+void Vl6180Drv::decodeRange(const Vl6180Results &results, RangeSample &sample) {
+    sample.range = results.rangeVal;
+    sample.error = results.rangeStatus >> 4;
+    sample.valid = (sample.error == VL6180_ERROR_NONE);
+    
+    // the rates are 9.7 fixed point
+    sample.returnRate = results.rangeReturnRate / 128.0;
+    sample.referenceRate = results.rangeReferenceRate / 128.0;
+    sample.returnSignalCount = results.rangeReturnSignalCount;
+    sample.referenceSignalCount = results.rangeReferenceSignalCount;
+    sample.returnAmbientCount = results.rangeReturnAmbCount;
+    sample.referenceAmbientCount = results.rangeReferenceAmbCount;
+    sample.returnConvTime = results.rangeReturnConvTime;
+    sample.referenceConvTime = results.rangeReferenceConvTime;
+}
+
+// Reads the result register window in one auto-incrementing burst and decodes it.
+// Only the first length bytes are transferred; fields beyond them are left zero.
+bool Vl6180Drv::readResults(Vl6180Results &results, uint16_t length) {
+    unsigned char block[VL6180_RESULT_BLOCK_SIZE];
+    
+    memset(block, 0, sizeof(block));
+    memset(&results, 0, sizeof(results));
+    
+    if (length > VL6180_RESULT_BLOCK_SIZE) {
+        length = VL6180_RESULT_BLOCK_SIZE;
+    }
+    
+    if (!readBlock(VL6180_RESULT_RANGE_STATUS, block, length).ok()) {
+        return false;
+    }
+    
+    // multi-byte registers on this device are big endian
+    #define RESULT_U8(reg)  ((uint8_t)block[(reg) - VL6180_RESULT_RANGE_STATUS])
+    #define RESULT_U16(reg) ((uint16_t)((RESULT_U8(reg) << 8) | RESULT_U8((reg) + 1)))
+    #define RESULT_U32(reg) (((uint32_t)RESULT_U16(reg) << 16) | RESULT_U16((reg) + 2))
+    
+    results.rangeStatus = RESULT_U8(VL6180_RESULT_RANGE_STATUS);
+    results.alsStatus = RESULT_U8(VL6180_RESULT_ALS_STATUS);
+    results.interruptStatus = RESULT_U8(VL6180_RESULT_INTERRUPT_STATUS_GPIO);
+    results.alsVal = RESULT_U16(VL6180_RESULT_ALS_VAL);
+    for (int i = 0; i < VL6180_RESULT_HISTORY_SIZE; i++) {
+        results.history[i] = RESULT_U16(VL6180_RESULT_HISTORY_BUFFER + (i * 2));
+    }
+    results.rangeVal = RESULT_U8(VL6180_RESULT_RANGE_VAL);
+    results.rangeRaw = RESULT_U8(VL6180_RESULT_RANGE_RAW);
+    results.rangeReturnRate = RESULT_U16(VL6180_RESULT_RANGE_RETURN_RATE);
+    results.rangeReferenceRate = RESULT_U16(VL6180_RESULT_RANGE_REFERENCE_RATE);
+    results.rangeReturnSignalCount = RESULT_U32(VL6180_RESULT_RANGE_RETURN_SIGNAL_COUNT);
+    results.rangeReferenceSignalCount = RESULT_U32(VL6180_RESULT_RANGE_REFERENCE_SIGNAL_COUNT);
+    results.rangeReturnAmbCount = RESULT_U32(VL6180_RESULT_RANGE_RETURN_AMB_COUNT);
+    results.rangeReferenceAmbCount = RESULT_U32(VL6180_RESULT_RANGE_REFERENCE_AMB_COUNT);
+    results.rangeReturnConvTime = RESULT_U32(VL6180_RESULT_RANGE_RETURN_CONV_TIME);
+    results.rangeReferenceConvTime = RESULT_U32(VL6180_RESULT_RANGE_REFERENCE_CONV_TIME);
+    
+    #undef RESULT_U32
+    #undef RESULT_U16
+    #undef RESULT_U8
+    
+    return true;
+}
+
+// Reads length consecutive registers starting at reg in one combined transaction.
+// The device auto-increments its register pointer across the read.
+i2cbus::I2CResult Vl6180Drv::readBlock(uint16_t reg, unsigned char *buffer, uint16_t length) {
+    unsigned char data_write[2];
+    data_write[0] = (reg >> 8) & 0xFF; // MSB of register address
+    data_write[1] = reg & 0xFF; // LSB of register address
+    
+    return track(this->writeRead(data_write, 2, buffer, length));
+}
+
+// Remembers the first failure since lastError was cleared, so a measurement can
+// tell that one of its register accesses went wrong
+i2cbus::I2CResult Vl6180Drv::track(const i2cbus::I2CResult &result) {
+    if (!result.ok() && !this->lastError) {
+        this->lastError = result.error;
+    }
+    return result;
+}
+
+int Vl6180Drv::getLastError() {
+    return this->lastError;
+}
+
+uint16_t Vl6180Drv::read16(uint16_t reg) {
+    unsigned char data_read[2] = {0, 0};
+    
+    // both bytes come back in one transfer, so the value cannot tear
+    readBlock(reg, data_read, 2);
+    
+    // MSB is at the lower address
+    return ((uint16_t)data_read[0] << 8) | data_read[1];
+}
+
+// seems that for this device, we need to split the 16-bit register in two,
+// so the usual writeRegister does not work, hence this method
+i2cbus::I2CResult Vl6180Drv::write8(uint16_t reg, unsigned char data) {
+    unsigned char data_write[3];
+    data_write[0] = (reg >> 8) & 0xFF;; // MSB of register address
+    data_write[1] = reg & 0xFF; // LSB of register address
+    data_write[2] = data & 0xFF;
+    
+    return track(this->write(data_write, 3));
+}
+
+// Queues a write8 on a transaction rather than sending it immediately
+void Vl6180Drv::queue8(i2cbus::I2CTransaction &transaction, uint16_t reg, unsigned char data) {
+    unsigned char data_write[3];
+    data_write[0] = (reg >> 8) & 0xFF; // MSB of register address
+    data_write[1] = reg & 0xFF; // LSB of register address
+    data_write[2] = data & 0xFF;
+    
+    transaction.write(data_write, 3);
+}
+
+// Writes a configuration register through the shadow, skipping the write when
+// the device already holds the value
+void Vl6180Drv::writeConfig8(uint16_t reg, unsigned char data) {
+    std::map<uint16_t, unsigned char>::iterator cached = this->shadow.find(reg);
+    if ((cached != this->shadow.end()) && (cached->second == data)) {
+        return;
+    }
+    
+    // only a write the device acknowledged is cached
+    if (write8(reg, data).ok()) {
+        this->shadow[reg] = data;
+    }
+    else {
+        this->shadow.erase(reg);
+    }
+}
+
+// Queues a configuration register write through the shadow. The shadow is updated
+// immediately, so callers must clear it if the transaction fails.
+void Vl6180Drv::queueConfig8(i2cbus::I2CTransaction &transaction, uint16_t reg, unsigned char data) {
+    std::map<uint16_t, unsigned char>::iterator cached = this->shadow.find(reg);
+    if ((cached != this->shadow.end()) && (cached->second == data)) {
+        return;
+    }
+    
+    queue8(transaction, reg, data);
+    this->shadow[reg] = data;
+}
+
+// Reads a configuration register from the shadow, going to the device only for
+// registers which have not been written or read before
+unsigned char Vl6180Drv::readConfig8(uint16_t reg) {
+    std::map<uint16_t, unsigned char>::iterator cached = this->shadow.find(reg);
+    if (cached != this->shadow.end()) {
+        return cached->second;
+    }
+    
+    unsigned char data = 0;
+    if (read8(reg, data).ok()) {
+        this->shadow[reg] = data;
+    }
+    
+    return data;
+}
+
+// 16-bit configuration registers go through the shadow a byte at a time, high byte first
+void Vl6180Drv::writeConfig16(uint16_t reg, uint16_t data) {
+    writeConfig8(reg, data >> 8);
+    writeConfig8(reg + 1, data & 0xFF);
+}
+
+void Vl6180Drv::queueConfig16(i2cbus::I2CTransaction &transaction, uint16_t reg, uint16_t data) {
+    queueConfig8(transaction, reg, data >> 8);
+    queueConfig8(transaction, reg + 1, data & 0xFF);
+}
+
+uint16_t Vl6180Drv::readConfig16(uint16_t reg) {
+    return ((uint16_t)readConfig8(reg) << 8) | readConfig8(reg + 1);
+}
+
+// seems that for this device, we need to split the 16-bit register in two,
+// so the usual readRegister does not work, hence this method
+unsigned char Vl6180Drv::read8(uint16_t reg) {
+    unsigned char data = 0;
+    read8(reg, data);
+    return data;
+}
+
+// As read8, reporting the result of this access alone
+i2cbus::I2CResult Vl6180Drv::read8(uint16_t reg, unsigned char &data) {
+    unsigned char data_read[1] = {0};
+    
+    // address write and data read joined by a repeated start
+    i2cbus::I2CResult result = readBlock(reg, data_read, 1);
+    
+    data = data_read[0];
+    return result;
+}
@@ -21,9 +21,20 @@
 #include <fcntl.h>
 #include <string.h>
 #include <unistd.h>
+#include <map>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "I2CDevice.h"
 #include "Device.h"
 #include "DataManip.h"
+#include "RingBuffer.h"
+#include "GpioLine.h"
 
 #define VL6180_DEFAULT_I2C_ADDR 0x29
 
@@ -36,6 +47,9 @@
 #define VL6180_ALS_GAIN_20        0x00
 #define VL6180_ALS_GAIN_40        0x07
 
+// SYSALS_INTEGRATION_PERIOD is a 16-bit register holding a 9-bit period, in ms less one
+#define VL6180_ALS_INTEGRATION_MAX_MS   512
+
 #define VL6180_ERROR_NONE         0
 #define VL6180_ERROR_SYSERR_1     1
 #define VL6180_ERROR_SYSERR_5     5
@@ -111,12 +125,215 @@
 #define VL6180_I2C_SLAVE_DEVICE_ADDRESS             0x0212
 #define VL6180_INTERLEAVED_MODE_ENABLE              0x02A3
 
+// The result registers from RESULT_RANGE_STATUS through the end of
+// RESULT_RANGE_REFERENCE_CONV_TIME form one contiguous, auto-incrementing window
+#define VL6180_RESULT_BLOCK_SIZE                    0x0037
+#define VL6180_RESULT_HISTORY_SIZE                  8
+
+// In range mode each history register packs two 8-bit ranges, newest in the high byte
+#define VL6180_RESULT_HISTORY_RANGES                (VL6180_RESULT_HISTORY_SIZE * 2)
+
+// Decoded contents of the result register window (0x004D - 0x0083)
+struct Vl6180Results {
+    uint8_t rangeStatus;
+    uint8_t alsStatus;
+    uint8_t interruptStatus;
+    uint16_t alsVal;
+    uint16_t history[VL6180_RESULT_HISTORY_SIZE];
+    uint8_t rangeVal;
+    uint8_t rangeRaw;
+    uint16_t rangeReturnRate;
+    uint16_t rangeReferenceRate;
+    uint32_t rangeReturnSignalCount;
+    uint32_t rangeReferenceSignalCount;
+    uint32_t rangeReturnAmbCount;
+    uint32_t rangeReferenceAmbCount;
+    uint32_t rangeReturnConvTime;
+    uint32_t rangeReferenceConvTime;
+};
+
+// Longest wait on the GPIO1 interrupt line before the status register is checked again
+#define VL6180_INTERRUPT_WAIT_US                    100000
+
+// Status polling starts at the initial interval and doubles up to the maximum
+#define VL6180_POLL_INITIAL_US                      250
+#define VL6180_POLL_MAXIMUM_US                      4000
+#define VL6180_POLL_MARGIN_US                       10000
+
+// Range pre-calibration time, which precedes convergence in every range measurement
+#define VL6180_RANGE_PRECAL_US                      3200
+
+// Time a sensor is held in shutdown, and its firmware boot time once released
+#define VL6180_SHUTDOWN_HOLD_US                     1000
+#define VL6180_BOOT_US                              1000
+
+// Range periods between history buffer fetches, below the buffer's 16 ranges so none are lost
+#define VL6180_HISTORY_BATCH                        12
+
+// Measurement periods between looks at the interrupt status in an event mode without an
+// interrupt line. An event stays latched until it is read, so this only delays it.
+#define VL6180_EVENT_POLL_PERIODS                   8
+
+// Raw ALS counts outside which auto ranging changes the gain and integration period,
+// and the count that the new settings are chosen to reach
+#define VL6180_ALS_AUTO_LOW                         1000
+#define VL6180_ALS_AUTO_HIGH                        40000
+#define VL6180_ALS_AUTO_TARGET                      8000
+
+// Raw ALS count of a saturated measurement, and how many times auto ranging measures
+// again at less sensitive settings after one
+#define VL6180_ALS_SATURATED                        0xFFFF
+#define VL6180_ALS_AUTO_RETRIES                     3
+
+// Number of samples held between drains in the continuous modes
+#define VL6180_SAMPLE_BUFFER_SIZE                   256
+
+enum Vl6180Mode {
+    VL6180_MODE_SINGLE_SHOT,
+    VL6180_MODE_CONTINUOUS_RANGE,
+    VL6180_MODE_INTERLEAVED,
+    VL6180_MODE_RANGE_HISTORY,
+    VL6180_MODE_RANGE_EVENTS,
+    VL6180_MODE_ALS_EVENTS
+};
+
+// Threshold event sources, numbered as the SYSTEM_INTERRUPT_CONFIG_GPIO and
+// RESULT_INTERRUPT_STATUS_GPIO codes
+enum Vl6180Threshold {
+    VL6180_THRESHOLD_LOW = 1,       // below the low threshold
+    VL6180_THRESHOLD_HIGH = 2,      // above the high threshold
+    VL6180_THRESHOLD_WINDOW = 3     // outside the window between the thresholds
+};
+
+// One range measurement with the sensor's error code and signal diagnostics
+struct RangeSample {
+    uint8_t range;                  // mm
+    uint8_t error;                  // VL6180_ERROR code from RESULT_RANGE_STATUS
+    bool valid;                     // no error, so the range can be used
+    float returnRate;               // Mcps
+    float referenceRate;            // Mcps
+    uint32_t returnSignalCount;
+    uint32_t referenceSignalCount;
+    uint32_t returnAmbientCount;
+    uint32_t referenceAmbientCount;
+    uint32_t returnConvTime;        // us
+    uint32_t referenceConvTime;     // us
+    uint64_t timestamp;             // steady clock microseconds when the sample was collected
+};
+
+// One paired range and ALS measurement collected in interleaved mode
+struct InterleavedSample {
+    uint8_t range;          // mm
+    bool rangeValid;        // no range error
+    float lux;
+    uint16_t alsCounts;     // raw ALS count
+    bool alsValid;          // ALS count not saturated
+    uint64_t timestamp;     // steady clock microseconds when the sample was collected
+};
+
+// A sensor sharing a bus with others, which all boot at the default address. Its GPIO0 line
+// holds it in shutdown until it is given its own address.
+struct Vl6180Slot {
+    std::string chip;       // GPIO character device with the shutdown line, for example /dev/gpiochip0
+    uint32_t offset;        // shutdown line within the chip
+    uint8_t addr;           // address the sensor is moved to
+};
+
+// One threshold event reported by the sensor in an event mode
+struct ThresholdEvent {
+    uint8_t code;           // the Vl6180Threshold which was crossed
+    uint8_t range;          // mm, in range event mode
+    float lux;              // in ALS event mode
+    uint64_t timestamp;     // steady clock microseconds when the event was collected
+};
+
+enum Vl6180TimingProfile {
+    VL6180_TIMING_MAX_RATE,
+    VL6180_TIMING_BALANCED,
+    VL6180_TIMING_LOW_NOISE,
+    VL6180_TIMING_CUSTOM
+};
+
+// Measurement timing registers, which trade latency against noise and range
+struct Vl6180Timing {
+    uint8_t convergenceMs;      // SYSRANGE_MAX_CONVERGENCE_TIME, 1 to 63ms
+    uint8_t averagingPeriod;    // READOUT_AVERAGING_SAMPLE_PERIOD, 1.3ms plus 64.5us steps
+    uint8_t vhvRepeatRate;      // SYSRANGE_VHV_REPEAT_RATE, ranges between recalibrations, 0 for never
+    uint8_t earlyConvergence;   // SYSRANGE_EARLY_CONVERGENCE_ESTIMATE
+    uint8_t rangePeriod;        // SYSRANGE_INTERMEASUREMENT_PERIOD, 10ms steps less one
+    uint8_t alsPeriod;          // SYSALS_INTERMEASUREMENT_PERIOD, 10ms steps less one
+};
+
+// Conversion times and continuous mode periods predicted for the active timing
+struct Vl6180Latency {
+    uint32_t rangeMinimumUs;    // range measurement which converges at once
+    uint32_t rangeMaximumUs;    // range measurement which runs to the convergence limit
+    uint32_t alsUs;
+    uint32_t rangePeriodUs;
+    uint32_t alsPeriodUs;
+};
+
+// One ALS measurement and the settings it was taken with
+struct AlsSample {
+    float lux;
+    uint16_t counts;        // raw ALS count
+    float gain;             // actual analog gain
+    uint16_t integrationMs;
+    uint64_t timestamp;     // steady clock microseconds when the sample was collected
+};
+
 
 class Vl6180Drv : public i2cbus::I2CDevice, public Device {
     
 public:
     Vl6180Drv(std::string devfile, uint32_t addr);
+    Vl6180Drv(std::shared_ptr<i2cbus::I2CTransport> transport, uint32_t addr);
+    ~Vl6180Drv();
     virtual std::string getValueAtIndex(int index);
+    virtual bool getNumberAtIndex(int index, double &value);
+    bool getRange(uint8_t &range);
+    bool getLux(float &lux);
+    int getLastError();
+    
+    bool startContinuousRange();
+    bool startInterleaved();
+    bool startRangeHistory();
+    bool startRangeEvents(Vl6180Threshold threshold, uint8_t low, uint8_t high);
+    bool startAlsEvents(Vl6180Threshold threshold, float low, float high);
+    void stopContinuous();
+    Vl6180Mode getMode();
+    bool latestRange(RangeSample &sample);
+    size_t drainRanges(RangeSample *samples, size_t max);
+    bool latestInterleaved(InterleavedSample &sample);
+    size_t drainInterleaved(InterleavedSample *samples, size_t max);
+    bool latestEvent(ThresholdEvent &event);
+    size_t drainEvents(ThresholdEvent *events, size_t max);
+    size_t getDroppedSamples();
+    
+    bool setInterruptLine(const std::string &chip, uint32_t offset);
+    void clearInterruptLine();
+    void setMeasurementTimeout(uint32_t timeoutUs);
+    
+    bool readRange(RangeSample &sample);
+    bool startRange();
+    int pollRange();
+    bool collectRange(RangeSample &sample);
+    bool readAls(AlsSample &sample);
+    void setAlsAutoRange(bool enable);
+    bool setAlsRange(uint8_t gain, uint16_t integrationMs);
+    
+    bool setTimingProfile(Vl6180TimingProfile profile);
+    bool setTimingProfile(const std::string &name);
+    bool setTiming(const Vl6180Timing &timing);
+    Vl6180Timing getTiming();
+    Vl6180TimingProfile getTimingProfile();
+    std::string getTimingProfileName();
+    Vl6180Latency getPredictedLatency();
+    
+    bool setAddress(uint8_t addr);
+    static int assignAddresses(const std::string &devfile, const std::vector<Vl6180Slot> &slots, std::vector<std::unique_ptr<GpioLine>> &lines);
+    static int assignAddresses(std::shared_ptr<i2cbus::I2CTransport> transport, const std::vector<Vl6180Slot> &slots, std::vector<std::unique_ptr<GpioLine>> &lines);
+    static int moveAddress(std::shared_ptr<i2cbus::I2CTransport> transport, uint8_t from, uint8_t to);
     
     static const int NUM_VALUES = 2;
     
@@ -128,14 +345,119 @@ protected:
     
 private:
     void loadSettings(void);
-    uint8_t readRangeStatus(void);
-    uint16_t read16(uint8_t reg);
-    void write8(uint16_t reg, unsigned char data);
+    template <typename T> T coalesce(std::shared_future<T> &slot, const std::function<T()> &measure);
+    bool rangeValue(uint8_t &range);
+    bool measureRange(RangeSample &sample);
+    void beginRange();
+    bool finishRange(RangeSample &sample);
+    static void decodeRange(const Vl6180Results &results, RangeSample &sample);
+    bool readResults(Vl6180Results &results, uint16_t length = VL6180_RESULT_BLOCK_SIZE);
+    i2cbus::I2CResult readBlock(uint16_t reg, unsigned char *buffer, uint16_t length);
+    i2cbus::I2CResult track(const i2cbus::I2CResult &result);
+    uint16_t read16(uint16_t reg);
+    i2cbus::I2CResult write8(uint16_t reg, unsigned char data);
+    void queue8(i2cbus::I2CTransaction &transaction, uint16_t reg, unsigned char data);
+    void writeConfig8(uint16_t reg, unsigned char data);
+    void queueConfig8(i2cbus::I2CTransaction &transaction, uint16_t reg, unsigned char data);
+    unsigned char readConfig8(uint16_t reg);
+    void writeConfig16(uint16_t reg, uint16_t data);
+    void queueConfig16(i2cbus::I2CTransaction &transaction, uint16_t reg, uint16_t data);
+    uint16_t readConfig16(uint16_t reg);
     unsigned char read8(uint16_t reg);
+    i2cbus::I2CResult read8(uint16_t reg, unsigned char &data);
+    
+    bool waitForRegister(uint16_t reg, uint8_t mask, uint8_t expected, uint32_t minimumUs, uint32_t expectedUs);
+    uint32_t measurementDeadlineUs(uint32_t expectedUs);
+    static i2cbus::I2CResult timedOut();
+    bool applyTiming(const Vl6180Timing &timing, Vl6180TimingProfile profile);
+    void queueTiming(i2cbus::I2CTransaction &transaction, const Vl6180Timing &timing);
+    uint32_t averagingUs();
+    uint32_t minimumRangeUs();
+    uint32_t maximumRangeUs();
+    uint32_t alsUs();
+    bool waitUntilIdle();
+    void startReader(Vl6180Mode mode);
+    void readContinuous();
+    bool collectContinuousRange();
+    bool collectInterleaved();
+    size_t collectRangeHistory();
+    bool collectEvent();
+    uint16_t luxToCounts(float lux, uint8_t gain, uint16_t integrationMs);
+    uint32_t rangePeriodUs();
+    uint32_t alsPeriodUs();
+    bool measureAls(AlsSample &sample);
+    bool convertAls(uint8_t gain, uint16_t integrationMs, uint16_t &counts);
+    void selectAlsRange(uint16_t counts);
+    float countsToLux(uint16_t counts, uint8_t gain, uint16_t integrationMs);
+    static float alsGainValue(uint8_t gain);
+    static uint64_t now();
+    
+    // ALS gain codes with their actual gains, and the auto ranging integration periods
+    struct AlsGain {
+        uint8_t code;
+        float gain;
+    };
+    static const AlsGain alsGains[];
+    static const uint16_t alsPeriods[];
+    
+    // timing register values and names, indexed by Vl6180TimingProfile
+    static const Vl6180Timing timingProfiles[];
+    static const char *timingNames[];
     
     // Create an array of read functions, so that multiple functions can be easily called
     typedef std::string(Vl6180Drv::*readValueType)();
     readValueType readFunction[NUM_VALUES] = { &Vl6180Drv::readValue0, &Vl6180Drv::readValue1 };
+    
+    // errno of the first failed register access in the current operation, 0 if none
+    int lastError = 0;
+    
+    // write-through copy of the configuration registers, loaded by loadSettings
+    std::map<uint16_t, unsigned char> shadow;
+    
+    // serializes register access between callers and the continuous reader
+    std::mutex lock;
+    
+    // measurement in progress for each index, which concurrent requests share
+    std::mutex flightLock;
+    std::shared_future<std::string> textInFlight[NUM_VALUES];
+    std::shared_future<std::pair<bool, double>> numberInFlight[NUM_VALUES];
+    
+    Vl6180Mode mode = VL6180_MODE_SINGLE_SHOT;
+    std::thread reader;
+    std::mutex readerLock;
+    std::condition_variable readerWake;
+    bool stopReader = false;
+    
+    // GPIO1 interrupt output, when it is wired to a GPIO character device line
+    GpioLine interruptLine;
+    
+    // fixed limit on each wait for the sensor, 0 to derive it from the conversion times
+    uint32_t measurementTimeoutUs = 0;
+    
+    RingBuffer<RangeSample, VL6180_SAMPLE_BUFFER_SIZE> ranges;
+    std::mutex latestLock;
+    RangeSample latest;
+    bool haveLatest = false;
+    uint64_t lastHistoryFetch = 0;
+    uint8_t historyRanges[VL6180_RESULT_HISTORY_RANGES];
+    
+    RingBuffer<InterleavedSample, VL6180_SAMPLE_BUFFER_SIZE> pairs;
+    InterleavedSample latestPair;
+    bool haveLatestPair = false;
+    RingBuffer<ThresholdEvent, VL6180_SAMPLE_BUFFER_SIZE> events;
+    ThresholdEvent lastEvent;
+    bool haveLastEvent = false;
+    
+    // a range begun by startRange and not yet collected, and when it is abandoned
+    bool rangePending = false;
+    uint64_t rangeDeadline = 0;
+    
+    uint8_t alsGain = VL6180_ALS_GAIN_5;
+    uint16_t alsIntegrationMs = 100;
+    bool alsAutoRange = false;
+    
+    Vl6180TimingProfile timingProfile = VL6180_TIMING_BALANCED;
+    Vl6180Timing timing = timingProfiles[VL6180_TIMING_BALANCED];
         
 };
 
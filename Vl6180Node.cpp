@@ -29,9 +29,15 @@ namespace vl6180 {
     using v8::Value;
     using v8::Number;
     using v8::Boolean;
+    using v8::Array;
+    using v8::Exception;
     
     Persistent<Function> Vl6180Node::constructor;
-    Vl6180Drv* Vl6180Node::driver = 0;
+    std::vector<std::unique_ptr<GpioLine>> Vl6180Node::shutdownLines;
+    uv_async_t Vl6180Node::resultAsync;
+    std::mutex Vl6180Node::resultLock;
+    std::vector<Vl6180Node::Work *> Vl6180Node::results;
+    size_t Vl6180Node::outstanding = 0;
     
     void Vl6180Node::Init(Local<Object> exports) {
         Isolate* isolate = exports->GetIsolate();
@@ -54,17 +60,31 @@ namespace vl6180 {
         NODE_SET_PROTOTYPE_METHOD(tpl, "deviceActive", isDeviceActive);
         NODE_SET_PROTOTYPE_METHOD(tpl, "valueAtIndexSync", getValueAtIndexSync);
         NODE_SET_PROTOTYPE_METHOD(tpl, "valueAtIndex", getValueAtIndex);
+        NODE_SET_PROTOTYPE_METHOD(tpl, "numberAtIndexSync", getNumberAtIndexSync);
+        NODE_SET_PROTOTYPE_METHOD(tpl, "numberAtIndex", getNumberAtIndex);
+        NODE_SET_PROTOTYPE_METHOD(tpl, "start", startStream);
+        NODE_SET_PROTOTYPE_METHOD(tpl, "stop", stopStream);
+        NODE_SET_PROTOTYPE_METHOD(tpl, "setTimingProfile", setTimingProfile);
+        NODE_SET_PROTOTYPE_METHOD(tpl, "predictedLatency", predictedLatency);
 
         // store a reference to this constructor
         constructor.Reset(isolate, tpl->GetFunction());
         
         exports->Set(String::NewFromUtf8(isolate, "Vl6180"), tpl->GetFunction());
+        
+        NODE_SET_METHOD(exports, "assignAddresses", assignAddresses);
+        NODE_SET_METHOD(exports, "sweep", sweep);
+        
+        // the handle only holds the loop open while requests are outstanding
+        uv_async_init(uv_default_loop(), &resultAsync, DeliverResults);
+        uv_unref((uv_handle_t *)&resultAsync);
     }
     
     void Vl6180Node::getDeviceName(const FunctionCallbackInfo<Value>& args) {
         Isolate* isolate = args.GetIsolate();
+        Vl6180Node* obj = ObjectWrap::Unwrap<Vl6180Node>(args.Holder());
         
-        std::string name = driver->getDeviceName();
+        std::string name = obj->driver->getDeviceName();
         Local<String> deviceName = String::NewFromUtf8(isolate, name.c_str());
         
         args.GetReturnValue().Set(deviceName);
@@ -72,8 +92,9 @@ namespace vl6180 {
     
     void Vl6180Node::getDeviceType(const FunctionCallbackInfo<Value>& args) {
         Isolate* isolate = args.GetIsolate();
+        Vl6180Node* obj = ObjectWrap::Unwrap<Vl6180Node>(args.Holder());
         
-        std::string type = driver->getDeviceType();
+        std::string type = obj->driver->getDeviceType();
         Local<String> deviceType = String::NewFromUtf8(isolate, type.c_str());
         
         args.GetReturnValue().Set(deviceType);
@@ -81,8 +102,9 @@ namespace vl6180 {
     
     void Vl6180Node::getDeviceVersion(const FunctionCallbackInfo<Value>& args) {
         Isolate* isolate = args.GetIsolate();
+        Vl6180Node* obj = ObjectWrap::Unwrap<Vl6180Node>(args.Holder());
         
-        std::string ver = driver->getVersion();
+        std::string ver = obj->driver->getVersion();
         Local<String> deviceVer = String::NewFromUtf8(isolate, ver.c_str());
         
         args.GetReturnValue().Set(deviceVer);
@@ -90,8 +112,9 @@ namespace vl6180 {
 
     void Vl6180Node::getDeviceNumValues (const FunctionCallbackInfo<Value>& args) {
         Isolate* isolate = args.GetIsolate();
+        Vl6180Node* obj = ObjectWrap::Unwrap<Vl6180Node>(args.Holder());
         
-        int value = driver->getNumValues();
+        int value = obj->driver->getNumValues();
         Local<Number> deviceNumVals = Number::New(isolate, value);
         
         args.GetReturnValue().Set(deviceNumVals);
@@ -99,8 +122,9 @@ namespace vl6180 {
     
     void Vl6180Node::getTypeAtIndex (const FunctionCallbackInfo<Value>& args) {
         Isolate* isolate = args.GetIsolate();
+        Vl6180Node* obj = ObjectWrap::Unwrap<Vl6180Node>(args.Holder());
         
-        std::string type = driver->getTypeAtIndex(args[0]->NumberValue());
+        std::string type = obj->driver->getTypeAtIndex(args[0]->NumberValue());
         Local<String> valType = String::NewFromUtf8(isolate, type.c_str());
         
         args.GetReturnValue().Set(valType);
@@ -108,8 +132,9 @@ namespace vl6180 {
     
     void Vl6180Node::getNameAtIndex (const FunctionCallbackInfo<Value>& args) {
         Isolate* isolate = args.GetIsolate();
+        Vl6180Node* obj = ObjectWrap::Unwrap<Vl6180Node>(args.Holder());
         
-        std::string name = driver->getNameAtIndex(args[0]->NumberValue());
+        std::string name = obj->driver->getNameAtIndex(args[0]->NumberValue());
         Local<String> valName = String::NewFromUtf8(isolate, name.c_str());
         
         args.GetReturnValue().Set(valName);
@@ -117,8 +142,9 @@ namespace vl6180 {
     
     void Vl6180Node::isDeviceActive (const FunctionCallbackInfo<Value>& args) {
         Isolate* isolate = args.GetIsolate();
+        Vl6180Node* obj = ObjectWrap::Unwrap<Vl6180Node>(args.Holder());
         
-        bool active = driver->isActive();
+        bool active = obj->driver->isActive();
         Local<Boolean> deviceActive = Boolean::New(isolate, active);
         
         args.GetReturnValue().Set(deviceActive);
@@ -126,8 +152,9 @@ namespace vl6180 {
     
     void Vl6180Node::getValueAtIndexSync (const FunctionCallbackInfo<Value>& args) {
         Isolate* isolate = args.GetIsolate();
+        Vl6180Node* obj = ObjectWrap::Unwrap<Vl6180Node>(args.Holder());
         
-        std::string value = driver->getValueAtIndex(args[0]->NumberValue());
+        std::string value = obj->driver->getValueAtIndex(args[0]->NumberValue());
         Local<String> retValue = String::NewFromUtf8(isolate, value.c_str());
         
         args.GetReturnValue().Set(retValue);
@@ -135,19 +162,63 @@ namespace vl6180 {
     
     void Vl6180Node::getValueAtIndex (const FunctionCallbackInfo<Value>& args) {
         Isolate* isolate = args.GetIsolate();
+        Vl6180Node* obj = ObjectWrap::Unwrap<Vl6180Node>(args.Holder());
+        
+        Work * work = new Work();
+        
+        // the object is kept alive until the work completes
+        work->node = obj;
+        obj->Ref();
+        
+        // get the desired value index from the first param in the JS call
+        work->valueIndex = args[0]->NumberValue();
+        work->numeric = false;
+        
+        // store the callback from JS in the work package so we can invoke it later
+        Local<Function> callback = Local<Function>::Cast(args[1]);
+        work->callback.Reset(isolate, callback);
+        
+        // hand the request to the acquisition thread
+        obj->queueWork(work);
+        
+        args.GetReturnValue().Set(Undefined(isolate));
+    }
+    
+    void Vl6180Node::getNumberAtIndexSync (const FunctionCallbackInfo<Value>& args) {
+        Isolate* isolate = args.GetIsolate();
+        Vl6180Node* obj = ObjectWrap::Unwrap<Vl6180Node>(args.Holder());
+        
+        double value;
+        if (!obj->driver->getNumberAtIndex(args[0]->NumberValue(), value)) {
+            args.GetReturnValue().Set(Null(isolate));
+            return;
+        }
+        
+        Local<Number> retValue = Number::New(isolate, value);
+        
+        args.GetReturnValue().Set(retValue);
+    }
+    
+    void Vl6180Node::getNumberAtIndex (const FunctionCallbackInfo<Value>& args) {
+        Isolate* isolate = args.GetIsolate();
+        Vl6180Node* obj = ObjectWrap::Unwrap<Vl6180Node>(args.Holder());
         
         Work * work = new Work();
-        work->request.data = work;
+        
+        // the object is kept alive until the work completes
+        work->node = obj;
+        obj->Ref();
         
         // get the desired value index from the first param in the JS call
         work->valueIndex = args[0]->NumberValue();
+        work->numeric = true;
         
         // store the callback from JS in the work package so we can invoke it later
         Local<Function> callback = Local<Function>::Cast(args[1]);
         work->callback.Reset(isolate, callback);
         
-        // kick of the worker thread
-        uv_queue_work(uv_default_loop(),&work->request,WorkAsync,WorkAsyncComplete);
+        // hand the request to the acquisition thread
+        obj->queueWork(work);
         
         args.GetReturnValue().Set(Undefined(isolate));
     }
@@ -163,7 +234,7 @@ namespace vl6180 {
         // if invoked as costructor: 'new Vl6180(...)'
         if (args.IsConstructCall()) {
             
-            Vl6180Node* obj = new Vl6180Node();
+            Vl6180Node* obj = new Vl6180Node(devfile, addr);
             
             obj->Wrap(args.This());
             
@@ -181,40 +252,521 @@ namespace vl6180 {
             
         }
         
-        if (!driver) {
-            driver = new Vl6180Drv(devfile, addr);
+    }
+    
+    // assignAddresses(devfile, [{chip, line, addr}, ...]) holds every sensor in shutdown, then
+    // releases them one at a time and moves each to its address. Throws an Error naming the
+    // errno of the first failure, in which case no lines are held.
+    void Vl6180Node::assignAddresses(const FunctionCallbackInfo<Value>& args) {
+        Isolate* isolate = args.GetIsolate();
+        
+        String::Utf8Value param0(args[0]->ToString());
+        std::string devfile = std::string(*param0);
+        
+        std::vector<Vl6180Slot> slots;
+        Local<Array> list = Local<Array>::Cast(args[1]);
+        for (uint32_t i = 0; i < list->Length(); i++) {
+            Local<Object> entry = list->Get(i)->ToObject();
+            
+            String::Utf8Value chip(entry->Get(String::NewFromUtf8(isolate, "chip"))->ToString());
+            
+            Vl6180Slot slot;
+            slot.chip = std::string(*chip);
+            slot.offset = entry->Get(String::NewFromUtf8(isolate, "line"))->NumberValue();
+            slot.addr = entry->Get(String::NewFromUtf8(isolate, "addr"))->NumberValue();
+            slots.push_back(slot);
+        }
+        
+        // the lines are held for the life of the module so the sensors stay out of shutdown
+        int error = Vl6180Drv::assignAddresses(devfile, slots, shutdownLines);
+        if (error) {
+            isolate->ThrowException(Exception::Error(String::NewFromUtf8(isolate, strerror(error))));
+            return;
+        }
+        
+        args.GetReturnValue().Set(Undefined(isolate));
+    }
+    
+    // sweep([vl6180, ...], callback) ranges every sensor once with their conversions running at
+    // the same time, on the first sensor's acquisition thread, then calls callback(err, ranges)
+    // with the range in mm, or null, of each sensor in order
+    void Vl6180Node::sweep(const FunctionCallbackInfo<Value>& args) {
+        Isolate* isolate = args.GetIsolate();
+        
+        if (!args[0]->IsArray() || !args[1]->IsFunction() || (Local<Array>::Cast(args[0])->Length() == 0)) {
+            isolate->ThrowException(Exception::TypeError(String::NewFromUtf8(isolate, "sweep takes a list of Vl6180 objects and a callback")));
+            return;
+        }
+        
+        Local<Array> list = Local<Array>::Cast(args[0]);
+        for (uint32_t i = 0; i < list->Length(); i++) {
+            if (!list->Get(i)->IsObject() || (list->Get(i)->ToObject()->InternalFieldCount() < 1)) {
+                isolate->ThrowException(Exception::TypeError(String::NewFromUtf8(isolate, "sweep takes a list of Vl6180 objects and a callback")));
+                return;
+            }
+        }
+        
+        Work * work = new Work();
+        
+        // every object is kept alive until the sweep completes
+        for (uint32_t i = 0; i < list->Length(); i++) {
+            Vl6180Node* obj = ObjectWrap::Unwrap<Vl6180Node>(list->Get(i)->ToObject());
+            obj->Ref();
+            work->sweepNodes.push_back(obj);
+        }
+        work->node = work->sweepNodes[0];
+        
+        Local<Function> callback = Local<Function>::Cast(args[1]);
+        work->callback.Reset(isolate, callback);
+        
+        work->node->queueWork(work);
+        
+        args.GetReturnValue().Set(Undefined(isolate));
+    }
+    
+    // start({period, indices, batchSize, queueSize, policy}, handler) samples the indices every
+    // period ms on a native thread, and calls handler(samples, dropped) with batches of
+    // batchSize samples. When the handler falls behind and queueSize samples are waiting, the
+    // policy 'drop-oldest', 'drop-newest' or 'pause' decides what happens to the next sample.
+    void Vl6180Node::startStream (const FunctionCallbackInfo<Value>& args) {
+        Isolate* isolate = args.GetIsolate();
+        Vl6180Node* obj = ObjectWrap::Unwrap<Vl6180Node>(args.Holder());
+        
+        if (obj->streaming || !args[1]->IsFunction()) {
+            args.GetReturnValue().Set(Boolean::New(isolate, false));
+            return;
+        }
+        
+        obj->streamIndices.clear();
+        obj->streamPeriodUs = 100000;
+        obj->streamBatchSize = 1;
+        obj->streamQueueSize = 1024;
+        obj->streamPolicy = STREAM_DROP_OLDEST;
+        
+        if (args[0]->IsObject()) {
+            Local<Object> options = args[0]->ToObject();
+            
+            Local<Value> period = options->Get(String::NewFromUtf8(isolate, "period"));
+            if (period->IsNumber() && (period->NumberValue() > 0)) {
+                obj->streamPeriodUs = period->NumberValue() * 1000;
+            }
+            
+            Local<Value> indices = options->Get(String::NewFromUtf8(isolate, "indices"));
+            if (indices->IsArray()) {
+                Local<Array> list = Local<Array>::Cast(indices);
+                for (uint32_t i = 0; i < list->Length(); i++) {
+                    obj->streamIndices.push_back(list->Get(i)->NumberValue());
+                }
+            }
+            
+            Local<Value> batchSize = options->Get(String::NewFromUtf8(isolate, "batchSize"));
+            if (batchSize->IsNumber() && (batchSize->NumberValue() >= 1)) {
+                obj->streamBatchSize = batchSize->NumberValue();
+            }
+            
+            Local<Value> queueSize = options->Get(String::NewFromUtf8(isolate, "queueSize"));
+            if (queueSize->IsNumber() && (queueSize->NumberValue() >= 1)) {
+                obj->streamQueueSize = queueSize->NumberValue();
+            }
+            
+            Local<Value> policy = options->Get(String::NewFromUtf8(isolate, "policy"));
+            if (policy->IsString()) {
+                String::Utf8Value name(policy->ToString());
+                std::string policyName = std::string(*name);
+                if (policyName == "drop-newest") {
+                    obj->streamPolicy = STREAM_DROP_NEWEST;
+                }
+                else if (policyName == "pause") {
+                    obj->streamPolicy = STREAM_PAUSE;
+                }
+            }
+        }
+        
+        if (obj->streamIndices.empty()) {
+            for (int i = 0; i < obj->driver->getNumValues(); i++) {
+                obj->streamIndices.push_back(i);
+            }
+        }
+        
+        // a batch never has to wait for more samples than the queue can hold
+        if (obj->streamBatchSize > obj->streamQueueSize) {
+            obj->streamBatchSize = obj->streamQueueSize;
+        }
+        
+        obj->streamHandler.Reset(isolate, Local<Function>::Cast(args[1]));
+        obj->streamQueue.clear();
+        obj->streamDropped = 0;
+        
+        obj->streamAsync = new uv_async_t;
+        obj->streamAsync->data = obj;
+        uv_async_init(uv_default_loop(), obj->streamAsync, DeliverStream);
+        
+        // the object stays alive while it streams
+        obj->Ref();
+        obj->streaming = true;
+        obj->streamer = std::thread(&Vl6180Node::stream, obj);
+        
+        args.GetReturnValue().Set(Boolean::New(isolate, true));
+    }
+    
+    // stop() ends streaming, handing any samples still queued to the handler first
+    void Vl6180Node::stopStream (const FunctionCallbackInfo<Value>& args) {
+        Isolate* isolate = args.GetIsolate();
+        Vl6180Node* obj = ObjectWrap::Unwrap<Vl6180Node>(args.Holder());
+        
+        if (!obj->streaming) {
+            args.GetReturnValue().Set(Boolean::New(isolate, false));
+            return;
+        }
+        
+        obj->endStream();
+        
+        // deliver the remainder, however short of a batch
+        DeliverStream(obj->streamAsync);
+        
+        obj->streamHandler.Reset();
+        uv_close((uv_handle_t *)obj->streamAsync, StreamClosed);
+        obj->streamAsync = nullptr;
+        obj->Unref();
+        
+        args.GetReturnValue().Set(Boolean::New(isolate, true));
+    }
+    
+    // setTimingProfile('max-rate' | 'balanced' | 'low-noise') selects a timing profile, and
+    // setTimingProfile({convergenceMs, averagingPeriod, vhvRepeatRate, earlyConvergence,
+    // rangePeriodUs, alsPeriodUs}) changes only the given fields of the current timing.
+    // Returns false when the name or a value is not accepted, or a continuous mode is running.
+    void Vl6180Node::setTimingProfile (const FunctionCallbackInfo<Value>& args) {
+        Isolate* isolate = args.GetIsolate();
+        Vl6180Node* obj = ObjectWrap::Unwrap<Vl6180Node>(args.Holder());
+        
+        bool applied = false;
+        
+        if (args[0]->IsString()) {
+            String::Utf8Value name(args[0]->ToString());
+            applied = obj->driver->setTimingProfile(std::string(*name));
+        }
+        else if (args[0]->IsObject()) {
+            Local<Object> options = args[0]->ToObject();
+            Vl6180Timing timing = obj->driver->getTiming();
+            
+            // a field given outside its register's range fails the whole call; the continuous
+            // mode periods are programmed in 10ms steps less one
+            bool valid = true;
+            auto field = [&](const char *key, uint8_t &value, double scale, double offset) {
+                Local<Value> given = options->Get(String::NewFromUtf8(isolate, key));
+                if (given->IsUndefined()) {
+                    return;
+                }
+                double steps = given->IsNumber() ? (given->NumberValue() / scale) - offset : -1;
+                if ((steps < 0) || (steps > 0xFF)) {
+                    valid = false;
+                    return;
+                }
+                value = steps;
+            };
+            
+            field("convergenceMs", timing.convergenceMs, 1, 0);
+            field("averagingPeriod", timing.averagingPeriod, 1, 0);
+            field("vhvRepeatRate", timing.vhvRepeatRate, 1, 0);
+            field("earlyConvergence", timing.earlyConvergence, 1, 0);
+            field("rangePeriodUs", timing.rangePeriod, 10000, 1);
+            field("alsPeriodUs", timing.alsPeriod, 10000, 1);
+            
+            applied = valid && obj->driver->setTiming(timing);
         }
         
+        args.GetReturnValue().Set(Boolean::New(isolate, applied));
+    }
+    
+    // predictedLatency() returns {profile, rangeMinimumUs, rangeMaximumUs, alsUs, rangePeriodUs,
+    // alsPeriodUs}, the conversion times and continuous mode periods of the current timing
+    void Vl6180Node::predictedLatency (const FunctionCallbackInfo<Value>& args) {
+        Isolate* isolate = args.GetIsolate();
+        Vl6180Node* obj = ObjectWrap::Unwrap<Vl6180Node>(args.Holder());
+        
+        Vl6180Latency latency = obj->driver->getPredictedLatency();
+        std::string profile = obj->driver->getTimingProfileName();
+        
+        Local<Object> retValue = Object::New(isolate);
+        retValue->Set(String::NewFromUtf8(isolate, "profile"), String::NewFromUtf8(isolate, profile.c_str()));
+        retValue->Set(String::NewFromUtf8(isolate, "rangeMinimumUs"), Number::New(isolate, latency.rangeMinimumUs));
+        retValue->Set(String::NewFromUtf8(isolate, "rangeMaximumUs"), Number::New(isolate, latency.rangeMaximumUs));
+        retValue->Set(String::NewFromUtf8(isolate, "alsUs"), Number::New(isolate, latency.alsUs));
+        retValue->Set(String::NewFromUtf8(isolate, "rangePeriodUs"), Number::New(isolate, latency.rangePeriodUs));
+        retValue->Set(String::NewFromUtf8(isolate, "alsPeriodUs"), Number::New(isolate, latency.alsPeriodUs));
+        
+        args.GetReturnValue().Set(retValue);
     }
     
-    // called by libuv worker in separate thread
-    void Vl6180Node::WorkAsync(uv_work_t *req) {
-        Work *work = static_cast<Work *>(req->data);
+    // the streaming thread, which samples every period, queues the samples under the
+    // policy, and wakes the event loop once a batch is ready
+    void Vl6180Node::stream() {
+        std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> wait(this->streamLock);
+        
+        while (this->streaming) {
+            
+            // with the pause policy, acquisition waits until the handler has made room. Nothing
+            // is ever dropped, so the set taken with the last room may run the queue up to one
+            // set past its size; waiting for room for a whole set could stall short of a batch.
+            if ((this->streamPolicy == STREAM_PAUSE) && (this->streamQueue.size() >= this->streamQueueSize)) {
+                this->streamWake.wait(wait);
+                next = std::chrono::steady_clock::now();
+                continue;
+            }
+            
+            wait.unlock();
+            
+            std::vector<StreamSample> taken;
+            for (size_t i = 0; i < this->streamIndices.size(); i++) {
+                StreamSample sample;
+                sample.index = this->streamIndices[i];
+                sample.valid = this->driver->getNumberAtIndex(sample.index, sample.value);
+                sample.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count() / 1000.0;
+                taken.push_back(sample);
+            }
+            
+            wait.lock();
+            
+            for (size_t i = 0; i < taken.size(); i++) {
+                if ((this->streamPolicy != STREAM_PAUSE) && (this->streamQueue.size() >= this->streamQueueSize)) {
+                    this->streamDropped++;
+                    if (this->streamPolicy == STREAM_DROP_NEWEST) {
+                        continue;
+                    }
+                    this->streamQueue.pop_front();
+                }
+                this->streamQueue.push_back(taken[i]);
+            }
+            
+            if (this->streamQueue.size() >= this->streamBatchSize) {
+                uv_async_send(this->streamAsync);
+            }
+            
+            // a period missed entirely is skipped rather than made up in a burst
+            next += std::chrono::microseconds(this->streamPeriodUs);
+            std::chrono::steady_clock::time_point current = std::chrono::steady_clock::now();
+            if (next < current) {
+                next = current;
+            }
+            
+            this->streamWake.wait_until(wait, next, [this]() { return !this->streaming; });
+        }
+    }
     
-        work->value = driver->getValueAtIndex(work->valueIndex);
+    // stops the streaming thread, leaving anything queued in place
+    void Vl6180Node::endStream() {
+        {
+            std::lock_guard<std::mutex> guard(this->streamLock);
+            if (!this->streaming) {
+                return;
+            }
+            this->streaming = false;
+        }
+        this->streamWake.notify_all();
+        
+        if (this->streamer.joinable()) {
+            this->streamer.join();
+        }
     }
     
-    // called by libuv in event loop when async function completes
-    void Vl6180Node::WorkAsyncComplete(uv_work_t *req, int status) {
+    // called by libuv in event loop when the streaming thread has a batch ready, delivering
+    // every full batch as an array of {index, value, timestamp}, where value is null if the
+    // sample was not valid, along with the count of samples dropped since the last call
+    void Vl6180Node::DeliverStream(uv_async_t *handle) {
         Isolate * isolate = Isolate::GetCurrent();
         
         v8::HandleScope handleScope(isolate);
         
-        Work *work = static_cast<Work *>(req->data);
+        Vl6180Node *obj = static_cast<Vl6180Node *>(handle->data);
+        
+        while (true) {
+            std::vector<StreamSample> batch;
+            size_t dropped;
+            {
+                std::lock_guard<std::mutex> guard(obj->streamLock);
+                // once stopped, a final short batch is delivered too
+                if (obj->streamQueue.empty() || (obj->streaming && (obj->streamQueue.size() < obj->streamBatchSize))) {
+                    break;
+                }
+                
+                size_t count = obj->streamQueue.size() < obj->streamBatchSize ? obj->streamQueue.size() : obj->streamBatchSize;
+                batch.assign(obj->streamQueue.begin(), obj->streamQueue.begin() + count);
+                obj->streamQueue.erase(obj->streamQueue.begin(), obj->streamQueue.begin() + count);
+                
+                dropped = obj->streamDropped;
+                obj->streamDropped = 0;
+            }
+            
+            // there is room again for a paused stream
+            obj->streamWake.notify_all();
+            
+            Local<Array> samples = Array::New(isolate, batch.size());
+            for (size_t i = 0; i < batch.size(); i++) {
+                Local<Object> sample = Object::New(isolate);
+                sample->Set(String::NewFromUtf8(isolate, "index"), Number::New(isolate, batch[i].index));
+                sample->Set(String::NewFromUtf8(isolate, "value"), batch[i].valid ? Local<Value>(Number::New(isolate, batch[i].value)) : Local<Value>(Null(isolate)));
+                sample->Set(String::NewFromUtf8(isolate, "timestamp"), Number::New(isolate, batch[i].timestamp));
+                samples->Set(i, sample);
+            }
+            
+            Handle<Value> argv[] = { samples, Number::New(isolate, dropped) };
+            
+            Local<Function>::New(isolate, obj->streamHandler)->Call(isolate->GetCurrentContext()->Global(), 2, argv);
+        }
+        
+    }
+    
+    void Vl6180Node::StreamClosed(uv_handle_t *handle) {
+        delete (uv_async_t *)handle;
+    }
+    
+    // called on the event loop thread to queue a request for the acquisition thread
+    void Vl6180Node::queueWork(Work *work) {
+        
+        if (outstanding++ == 0) {
+            uv_ref((uv_handle_t *)&resultAsync);
+        }
+        
+        std::lock_guard<std::mutex> guard(this->requestLock);
+        
+        if (!this->acquirer.joinable()) {
+            this->acquirer = std::thread(&Vl6180Node::acquire, this);
+        }
+        
+        this->requests.push_back(work);
+        this->requestWake.notify_one();
+    }
+    
+    // the acquisition thread, which measures requests in order and posts the results
+    void Vl6180Node::acquire() {
+        std::unique_lock<std::mutex> wait(this->requestLock);
         
-        // the work has been done, and now we store the value as a v8 string
+        while (true) {
+            this->requestWake.wait(wait, [this]() { return this->stopping || !this->requests.empty(); });
+            
+            if (this->requests.empty()) {
+                return;
+            }
+            
+            Work *work = this->requests.front();
+            this->requests.pop_front();
+            
+            // requests queued for the same value are answered by the same measurement
+            std::vector<Work *> answered(1, work);
+            if (work->sweepNodes.empty()) {
+                for (std::deque<Work *>::iterator queued = this->requests.begin(); queued != this->requests.end(); ) {
+                    if ((*queued)->sweepNodes.empty() && ((*queued)->numeric == work->numeric) && ((*queued)->valueIndex == work->valueIndex)) {
+                        answered.push_back(*queued);
+                        queued = this->requests.erase(queued);
+                    }
+                    else {
+                        ++queued;
+                    }
+                }
+            }
+            wait.unlock();
+            
+            if (!work->sweepNodes.empty()) {
+                Vl6180Scheduler scheduler;
+                for (size_t i = 0; i < work->sweepNodes.size(); i++) {
+                    scheduler.add(work->sweepNodes[i]->driver.get());
+                }
+                scheduler.sweep(work->ranges);
+            }
+            else if (work->numeric) {
+                work->valid = this->driver->getNumberAtIndex(work->valueIndex, work->number);
+            }
+            else {
+                work->value = this->driver->getValueAtIndex(work->valueIndex);
+            }
+            
+            for (size_t i = 1; i < answered.size(); i++) {
+                answered[i]->value = work->value;
+                answered[i]->valid = work->valid;
+                answered[i]->number = work->number;
+            }
+            
+            {
+                std::lock_guard<std::mutex> guard(resultLock);
+                results.insert(results.end(), answered.begin(), answered.end());
+            }
+            uv_async_send(&resultAsync);
+            
+            wait.lock();
+        }
+    }
+    
+    // pending requests keep the object referenced, so none are left when this is called
+    void Vl6180Node::stopAcquisition() {
+        {
+            std::lock_guard<std::mutex> guard(this->requestLock);
+            this->stopping = true;
+        }
+        this->requestWake.notify_all();
         
-        Local<String> retValue = String::NewFromUtf8(isolate, work->value.c_str());
+        if (this->acquirer.joinable()) {
+            this->acquirer.join();
+        }
+    }
+    
+    // called by libuv in event loop once results have been posted, delivering all of them
+    void Vl6180Node::DeliverResults(uv_async_t *handle) {
+        Isolate * isolate = Isolate::GetCurrent();
         
-        // set up return arguments: 0 = error, 1 = returned value
-        Handle<Value> argv[] = { Null(isolate) , retValue };
+        v8::HandleScope handleScope(isolate);
         
-        // execute the callback
-        Local<Function>::New(isolate, work->callback)->Call(isolate->GetCurrentContext()->Global(), 2, argv);
+        std::vector<Work *> finished;
+        {
+            std::lock_guard<std::mutex> guard(resultLock);
+            finished.swap(results);
+        }
         
-        // Free up the persistent function callback
-        work->callback.Reset();
-        delete work;
+        for (size_t i = 0; i < finished.size(); i++) {
+            Work *work = finished[i];
+            
+            // the work has been done, and now we store the value as a v8 string, or as a
+            // v8 number for numeric requests
+            
+            Local<Value> retValue;
+            if (!work->sweepNodes.empty()) {
+                Local<Array> ranges = Array::New(isolate, work->ranges.size());
+                for (size_t r = 0; r < work->ranges.size(); r++) {
+                    const RangeSample &sample = work->ranges[r];
+                    ranges->Set(r, sample.valid ? Local<Value>(Number::New(isolate, sample.range)) : Local<Value>(Null(isolate)));
+                }
+                retValue = ranges;
+            }
+            else if (work->numeric) {
+                retValue = work->valid ? Local<Value>(Number::New(isolate, work->number)) : Local<Value>(Null(isolate));
+            }
+            else {
+                retValue = String::NewFromUtf8(isolate, work->value.c_str());
+            }
+            
+            // set up return arguments: 0 = error, 1 = returned value
+            Handle<Value> argv[] = { Null(isolate) , retValue };
+            
+            // execute the callback
+            Local<Function>::New(isolate, work->callback)->Call(isolate->GetCurrentContext()->Global(), 2, argv);
+            
+            // Free up the persistent function callback
+            work->callback.Reset();
+            if (!work->sweepNodes.empty()) {
+                for (size_t n = 0; n < work->sweepNodes.size(); n++) {
+                    work->sweepNodes[n]->Unref();
+                }
+            }
+            else {
+                work->node->Unref();
+            }
+            delete work;
+            
+            if (--outstanding == 0) {
+                uv_unref((uv_handle_t *)&resultAsync);
+            }
+        }
         
     }
 
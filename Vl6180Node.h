@@ -22,7 +22,13 @@
 #include <cmath>
 #include <string>
 #include <thread>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
 #include "Vl6180Drv.h"
+#include "Vl6180Scheduler.h"
 
 namespace vl6180 {
     
@@ -40,28 +46,110 @@ public:
     static void isDeviceActive (const v8::FunctionCallbackInfo<v8::Value>& args);
     static void getValueAtIndexSync (const v8::FunctionCallbackInfo<v8::Value>& args);
     static void getValueAtIndex (const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void getNumberAtIndexSync (const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void getNumberAtIndex (const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void assignAddresses (const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void sweep (const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void startStream (const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void stopStream (const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void setTimingProfile (const v8::FunctionCallbackInfo<v8::Value>& args);
+    static void predictedLatency (const v8::FunctionCallbackInfo<v8::Value>& args);
     
 private:
     
-    explicit Vl6180Node(std::string devfile = "/dev/i2c-1", uint32_t addr = 0x29) {}
+    explicit Vl6180Node(std::string devfile = "/dev/i2c-1", uint32_t addr = 0x29) {
+        driver.reset(new Vl6180Drv(devfile, addr));
+    }
     
-    ~Vl6180Node() {}
+    // the threads using the driver are stopped before it is destroyed
+    ~Vl6180Node() {
+        endStream();
+        stopAcquisition();
+    }
     
     static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
     
-    static void WorkAsync(uv_work_t *req);
-    static void WorkAsyncComplete(uv_work_t *req,int status);
+    struct Work;
+    
+    void queueWork(Work *work);
+    void acquire();
+    void stopAcquisition();
+    static void DeliverResults(uv_async_t *handle);
+    
+    void stream();
+    void endStream();
+    static void DeliverStream(uv_async_t *handle);
+    static void StreamClosed(uv_handle_t *handle);
     
     static v8::Persistent<v8::Function> constructor;
     
-    static Vl6180Drv *driver;
+    // each object drives its own sensor
+    std::unique_ptr<Vl6180Drv> driver;
+    
+    // shutdown lines held after assignAddresses
+    static std::vector<std::unique_ptr<GpioLine>> shutdownLines;
+    
+    // asynchronous requests are measured on the object's own acquisition thread, which is
+    // started by the first one, rather than on the shared libuv threadpool. Requests waiting
+    // for the same value share one measurement.
+    std::thread acquirer;
+    std::mutex requestLock;
+    std::condition_variable requestWake;
+    std::deque<Work *> requests;
+    bool stopping = false;
+    
+    // finished requests from every object, handed to the event loop by one async handle.
+    // Sends made before the loop runs the handle are merged, so one wakeup delivers them all.
+    static uv_async_t resultAsync;
+    static std::mutex resultLock;
+    static std::vector<Work *> results;
+    static size_t outstanding;
+    
+    // what the streaming thread does with a new sample when the queue is full
+    enum StreamPolicy {
+        STREAM_DROP_OLDEST,
+        STREAM_DROP_NEWEST,
+        STREAM_PAUSE
+    };
+    
+    struct StreamSample {
+        int index;
+        bool valid;
+        double value;
+        double timestamp;       // ms since the epoch
+    };
+    
+    // samples taken by the streaming thread every period and handed to the JS handler in
+    // batches, through a bounded queue
+    std::thread streamer;
+    std::mutex streamLock;
+    std::condition_variable streamWake;
+    std::deque<StreamSample> streamQueue;
+    std::vector<int> streamIndices;
+    uint32_t streamPeriodUs = 100000;
+    size_t streamBatchSize = 1;
+    size_t streamQueueSize = 1024;
+    StreamPolicy streamPolicy = STREAM_DROP_OLDEST;
+    size_t streamDropped = 0;
+    bool streaming = false;
+    uv_async_t *streamAsync = nullptr;
+    v8::Persistent<v8::Function> streamHandler;
     
     struct Work {
-        uv_work_t  request;
+        Vl6180Node *node;
         v8::Persistent<v8::Function> callback;
         
         int valueIndex;
         std::string value;
+        
+        // numeric requests return number, or null when valid is false
+        bool numeric;
+        bool valid;
+        double number;
+        
+        // a sweep ranges every listed object at once, each held referenced until delivery
+        std::vector<Vl6180Node *> sweepNodes;
+        std::vector<RangeSample> ranges;
     };
 
     
@@ -0,0 +1,102 @@
+/**
+ * \file Vl6180Scheduler.cpp
+ *
+ *  Copyright (c) 2026 Agilatech. All rights reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "Vl6180Scheduler.h"
+
+Vl6180Scheduler::Vl6180Scheduler() {
+}
+
+/**
+ * Add a sensor to the sweep. The scheduler does not own it, and it has to be in single shot mode.
+ * @param sensor The sensor, which has to outlive the scheduler
+ */
+void Vl6180Scheduler::add(Vl6180Drv *sensor) {
+    this->sensors.push_back(sensor);
+}
+
+void Vl6180Scheduler::clear() {
+    this->sensors.clear();
+}
+
+size_t Vl6180Scheduler::size() {
+    return this->sensors.size();
+}
+
+/**
+ * Range every sensor once, with the measurements running at the same time
+ * @param samples Receives one sample per sensor, in the order they were added. A sensor which could
+ * not be started or read, or whose measurement the sensor rejected, has valid set false.
+ * @return the number of valid samples
+ */
+size_t Vl6180Scheduler::sweep(std::vector<RangeSample> &samples) {
+    size_t count = this->sensors.size();
+    
+    RangeSample empty;
+    memset(&empty, 0, sizeof(empty));
+    samples.assign(count, empty);
+    
+    std::vector<bool> pending(count, false);
+    size_t remaining = 0;
+    uint32_t minimumUs = 0;
+    
+    // every conversion is under way before any sensor is looked at
+    for (size_t i = 0; i < count; i++) {
+        if (this->sensors[i]->startRange()) {
+            pending[i] = true;
+            remaining++;
+            
+            uint32_t sensorUs = this->sensors[i]->getPredictedLatency().rangeMinimumUs;
+            if ((minimumUs == 0) || (sensorUs < minimumUs)) {
+                minimumUs = sensorUs;
+            }
+        }
+    }
+    
+    if (remaining) {
+        std::this_thread::sleep_for(std::chrono::microseconds(minimumUs));
+    }
+    
+    // poll the sensors still converging, backing off as in a single measurement
+    uint32_t intervalUs = VL6180_POLL_INITIAL_US;
+    size_t valid = 0;
+    
+    while (remaining) {
+        for (size_t i = 0; i < count; i++) {
+            if (!pending[i]) {
+                continue;
+            }
+            
+            int ready = this->sensors[i]->pollRange();
+            if (ready == 0) {
+                continue;
+            }
+            
+            if ((ready > 0) && this->sensors[i]->collectRange(samples[i]) && samples[i].valid) {
+                valid++;
+            }
+            
+            pending[i] = false;
+            remaining--;
+        }
+        
+        if (remaining) {
+            std::this_thread::sleep_for(std::chrono::microseconds(intervalUs));
+            
+            if (intervalUs < VL6180_POLL_MAXIMUM_US) {
+                intervalUs *= 2;
+            }
+        }
+    }
+    
+    return valid;
+}
@@ -0,0 +1,42 @@
+/**
+ * \file Vl6180Scheduler.h
+ *
+ *  Copyright (c) 2026 Agilatech. All rights reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __Vl6180Scheduler__
+#define __Vl6180Scheduler__
+
+#include <vector>
+#include "Vl6180Drv.h"
+
+/**
+ * @class Vl6180Scheduler
+ * @brief Ranges a group of sensors with their conversions overlapped
+ *
+ * A sweep starts a range measurement on every sensor before collecting any, then collects each
+ * one as it becomes ready. The sensors converge at the same time, so a sweep takes about one
+ * conversion plus the bus time, however many sensors there are. The sensors may share a bus.
+ */
+class Vl6180Scheduler {
+    
+public:
+    Vl6180Scheduler();
+    
+    void add(Vl6180Drv *sensor);
+    void clear();
+    size_t size();
+    size_t sweep(std::vector<RangeSample> &samples);
+    
+protected:
+    std::vector<Vl6180Drv *> sensors;
+};
+
+#endif /* __Vl6180Scheduler__ */
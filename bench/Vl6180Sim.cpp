@@ -0,0 +1,370 @@
+/**
+ * \file Vl6180Sim.cpp
+ *
+ *  Copyright (c) 2026 Agilatech. All rights reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "Vl6180Sim.h"
+
+Vl6180Sim::Vl6180Sim(uint8_t addr) {
+    
+    memset(this->registers, 0, sizeof(this->registers));
+    
+    this->registers[VL6180_IDENTIFICATION_MODEL_ID] = 0xB4;
+    this->registers[VL6180_SYSTEM_FRESH_OUT_OF_RESET] = 0x01;
+    this->registers[VL6180_RESULT_RANGE_STATUS] = 0x01;
+    this->registers[VL6180_RESULT_ALS_STATUS] = 0x01;
+    this->registers[VL6180_SYSALS_ANALOGUE_GAIN] = 0x40 | VL6180_ALS_GAIN_1;
+    this->registers[VL6180_SYSALS_INTEGRATION_PERIOD + 1] = 100 - 1;
+    this->registers[VL6180_I2C_SLAVE_DEVICE_ADDRESS] = addr;
+}
+
+uint8_t Vl6180Sim::getAddr() {
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->registers[VL6180_I2C_SLAVE_DEVICE_ADDRESS];
+}
+
+// Sets the distance and error code reported by the following range measurements. Measurements
+// are completed lazily, so any already due are completed first with the previous value.
+void Vl6180Sim::setRange(uint8_t range, uint8_t error) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->update();
+    this->range = range;
+    this->rangeError = error;
+}
+
+// Sets the illuminance seen by the following ALS measurements, completing any already due first
+void Vl6180Sim::setLux(float lux) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->update();
+    this->lux = lux;
+}
+
+void Vl6180Sim::setRangeConversionTime(uint32_t us) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->rangeConversionUs = us;
+}
+
+// 0 makes the ALS conversion take as long as the programmed integration period
+void Vl6180Sim::setAlsConversionTime(uint32_t us) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->alsConversionUs = us;
+}
+
+// Reads a register without any of the side effects of a bus read
+uint8_t Vl6180Sim::peek(uint16_t reg) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->update();
+    return (reg < VL6180_SIM_REGISTER_COUNT) ? this->registers[reg] : 0;
+}
+
+// A write message carries the 16-bit register address followed by any data bytes,
+// which are written to consecutive registers. Returns 1 where the device would NACK.
+int Vl6180Sim::write(const unsigned char *data, uint16_t length) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    
+    if (length < 2) {
+        return 1;
+    }
+    
+    this->update();
+    
+    this->pointer = (data[0] << 8) | data[1];
+    for (int i = 2; i < length; i++) {
+        this->writeRegister(this->pointer++, data[i]);
+    }
+    
+    return 0;
+}
+
+// A read message returns consecutive registers from the current register pointer
+int Vl6180Sim::read(unsigned char *data, uint16_t length) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    
+    this->update();
+    
+    for (int i = 0; i < length; i++) {
+        data[i] = this->readRegister(this->pointer++);
+    }
+    
+    return 0;
+}
+
+// Completes any measurement whose conversion time has passed
+void Vl6180Sim::update() {
+    Clock::time_point now = Clock::now();
+    
+    // a continuous measurement which has fallen behind keeps only its newest result
+    while (this->rangeBusy && (now >= this->rangeDue)) {
+        this->completeRange();
+    }
+    
+    while (this->alsBusy && (now >= this->alsDue)) {
+        Clock::time_point completed = this->alsDue;
+        this->completeAls();
+        
+        // in interleaved mode every ALS measurement is followed by a range measurement
+        if (this->registers[VL6180_INTERLEAVED_MODE_ENABLE] & 0x01) {
+            this->rangeBusy = true;
+            this->rangeDue = completed + std::chrono::microseconds(this->rangeConversionUs);
+            this->registers[VL6180_RESULT_RANGE_STATUS] &= ~0x01;
+            if (now >= this->rangeDue) {
+                this->completeRange();
+            }
+        }
+    }
+}
+
+// SYSALS_INTEGRATION_PERIOD, a 9-bit period in ms less one across two registers
+uint32_t Vl6180Sim::integrationMs() {
+    uint16_t period = ((uint16_t)this->registers[VL6180_SYSALS_INTEGRATION_PERIOD] << 8) | this->registers[VL6180_SYSALS_INTEGRATION_PERIOD + 1];
+    return (period & 0x1FF) + 1;
+}
+
+// ALS conversion time, by default the programmed integration period
+uint32_t Vl6180Sim::alsTimeUs() {
+    if (this->alsConversionUs) {
+        return this->alsConversionUs;
+    }
+    return this->integrationMs() * 1000;
+}
+
+void Vl6180Sim::writeRegister(uint16_t reg, uint8_t value) {
+    
+    if (reg >= VL6180_SIM_REGISTER_COUNT) {
+        return;
+    }
+    
+    switch (reg) {
+        case VL6180_SYSRANGE_START:
+            if ((value & 0x01) && this->rangeContinuous) {
+                // the start bit stops a continuous measurement
+                this->rangeContinuous = false;
+                this->rangeBusy = false;
+                this->registers[VL6180_RESULT_RANGE_STATUS] |= 0x01;
+            }
+            else if ((value & 0x01) && !this->rangeBusy) {
+                this->rangeContinuous = (value & 0x02) != 0;
+                this->rangeBusy = true;
+                this->rangeDue = Clock::now() + std::chrono::microseconds(this->rangeConversionUs);
+                this->registers[VL6180_RESULT_RANGE_STATUS] &= ~0x01;
+            }
+            // the start bit clears itself
+            this->registers[reg] = value & ~0x01;
+            break;
+            
+        case VL6180_SYSALS_START:
+            if ((value & 0x01) && this->alsContinuous) {
+                this->alsContinuous = false;
+                this->alsBusy = false;
+                this->registers[VL6180_RESULT_ALS_STATUS] |= 0x01;
+            }
+            else if ((value & 0x01) && !this->alsBusy) {
+                this->alsContinuous = (value & 0x02) != 0;
+                this->alsBusy = true;
+                this->alsDue = Clock::now() + std::chrono::microseconds(this->alsTimeUs());
+                this->registers[VL6180_RESULT_ALS_STATUS] &= ~0x01;
+            }
+            this->registers[reg] = value & ~0x01;
+            break;
+            
+        case VL6180_SYSTEM_HISTORY_CTRL:
+            // bit 2 clears the buffer and clears itself
+            if (value & 0x04) {
+                memset(&this->registers[VL6180_RESULT_HISTORY_BUFFER], 0, VL6180_RESULT_HISTORY_SIZE * 2);
+            }
+            this->registers[reg] = value & ~0x04;
+            break;
+            
+        case VL6180_SYSTEM_INTERRUPT_CLEAR:
+            // bit 0 clears range, bit 1 clears ALS, bit 2 clears error
+            if (value & 0x01) {
+                this->registers[VL6180_RESULT_INTERRUPT_STATUS_GPIO] &= ~0x07;
+            }
+            if (value & 0x02) {
+                this->registers[VL6180_RESULT_INTERRUPT_STATUS_GPIO] &= ~0x38;
+            }
+            if (value & 0x04) {
+                this->registers[VL6180_RESULT_INTERRUPT_STATUS_GPIO] &= ~0xC0;
+            }
+            break;
+            
+        case VL6180_IDENTIFICATION_MODEL_ID:
+            // read only
+            break;
+            
+        default:
+            this->registers[reg] = value;
+            break;
+    }
+}
+
+uint8_t Vl6180Sim::readRegister(uint16_t reg) {
+    return (reg < VL6180_SIM_REGISTER_COUNT) ? this->registers[reg] : 0;
+}
+
+void Vl6180Sim::completeRange() {
+    if (this->rangeContinuous) {
+        // SYSRANGE_INTERMEASUREMENT_PERIOD counts in 10ms steps
+        uint32_t periodUs = (this->registers[VL6180_SYSRANGE_INTERMEASUREMENT_PERIOD] + 1) * 10000;
+        this->rangeDue += std::chrono::microseconds(periodUs);
+    }
+    else {
+        this->rangeBusy = false;
+    }
+    
+    this->registers[VL6180_RESULT_RANGE_VAL] = this->range;
+    
+    // history enabled in range mode: each register holds two ranges, so the older results
+    // shift back one byte and the newest lands in the high byte of the first register
+    if ((this->registers[VL6180_SYSTEM_HISTORY_CTRL] & 0x03) == 0x01) {
+        uint8_t *history = &this->registers[VL6180_RESULT_HISTORY_BUFFER];
+        memmove(history + 1, history, VL6180_RESULT_HISTORY_RANGES - 1);
+        history[0] = this->range;
+    }
+    this->registers[VL6180_RESULT_RANGE_STATUS] = (this->rangeError << 4) | 0x01;
+    
+    uint8_t event = this->rangeEvent(this->range);
+    if (event) {
+        uint8_t &status = this->registers[VL6180_RESULT_INTERRUPT_STATUS_GPIO];
+        status = (status & ~0x07) | event;
+    }
+}
+
+void Vl6180Sim::completeAls() {
+    if (this->alsContinuous) {
+        // SYSALS_INTERMEASUREMENT_PERIOD counts in 10ms steps
+        uint32_t periodUs = (this->registers[VL6180_SYSALS_INTERMEASUREMENT_PERIOD] + 1) * 10000;
+        this->alsDue += std::chrono::microseconds(periodUs);
+    }
+    else {
+        this->alsBusy = false;
+    }
+    
+    float counts = (this->lux / 0.32) * this->alsGain() * this->integrationMs() / 100;
+    uint16_t value = (counts > 0xFFFF) ? 0xFFFF : (uint16_t)counts;
+    
+    this->registers[VL6180_RESULT_ALS_VAL] = value >> 8;
+    this->registers[VL6180_RESULT_ALS_VAL + 1] = value & 0xFF;
+    this->registers[VL6180_RESULT_ALS_STATUS] = 0x01;
+    
+    uint8_t event = this->alsEvent(value);
+    if (event) {
+        uint8_t &status = this->registers[VL6180_RESULT_INTERRUPT_STATUS_GPIO];
+        status = (status & ~0x38) | (event << 3);
+    }
+}
+
+// Interrupt code raised by a range result under SYSTEM_INTERRUPT_CONFIG_GPIO bits [2:0]
+uint8_t Vl6180Sim::rangeEvent(uint8_t value) {
+    uint8_t config = this->registers[VL6180_SYSTEM_INTERRUPT_CONFIG_GPIO] & 0x07;
+    uint8_t high = this->registers[VL6180_SYSRANGE_THRESH_HIGH];
+    uint8_t low = this->registers[VL6180_SYSRANGE_THRESH_LOW];
+    
+    switch (config) {
+        case 1: return (value < low) ? 1 : 0;
+        case 2: return (value > high) ? 2 : 0;
+        case 3: return ((value < low) || (value > high)) ? 3 : 0;
+        case 4: return 4;
+        default: return 0;
+    }
+}
+
+// Interrupt code raised by an ALS result under SYSTEM_INTERRUPT_CONFIG_GPIO bits [5:3]
+uint8_t Vl6180Sim::alsEvent(uint16_t value) {
+    uint8_t config = (this->registers[VL6180_SYSTEM_INTERRUPT_CONFIG_GPIO] >> 3) & 0x07;
+    uint16_t high = (this->registers[VL6180_SYSALS_THRESH_HIGH] << 8) | this->registers[VL6180_SYSALS_THRESH_HIGH + 1];
+    uint16_t low = (this->registers[VL6180_SYSALS_THRESH_LOW] << 8) | this->registers[VL6180_SYSALS_THRESH_LOW + 1];
+    
+    switch (config) {
+        case 1: return (value < low) ? 1 : 0;
+        case 2: return (value > high) ? 2 : 0;
+        case 3: return ((value < low) || (value > high)) ? 3 : 0;
+        case 4: return 4;
+        default: return 0;
+    }
+}
+
+// actual rather than nominal gains, as the part has them
+float Vl6180Sim::alsGain() {
+    switch (this->registers[VL6180_SYSALS_ANALOGUE_GAIN] & 0x07) {
+        case VL6180_ALS_GAIN_20: return 20;
+        case VL6180_ALS_GAIN_10: return 10.32;
+        case VL6180_ALS_GAIN_5: return 5.21;
+        case VL6180_ALS_GAIN_2_5: return 2.60;
+        case VL6180_ALS_GAIN_1_67: return 1.72;
+        case VL6180_ALS_GAIN_1_25: return 1.28;
+        case VL6180_ALS_GAIN_1: return 1.01;
+        default: return 40;
+    }
+}
+
+Vl6180SimBus::Vl6180SimBus(uint32_t byteTimeUs, uint32_t messageTimeUs) : transfers(0), messageCount(0), bytes(0) {
+    this->byteTimeUs = byteTimeUs;
+    this->messageTimeUs = messageTimeUs;
+}
+
+void Vl6180SimBus::attach(std::shared_ptr<Vl6180Sim> sensor) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->sensors.push_back(sensor);
+}
+
+int Vl6180SimBus::transfer(struct i2c_msg *messages, uint32_t count) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    
+    uint32_t busTimeUs = 0;
+    int result = 0;
+    
+    this->transfers++;
+    
+    for (uint32_t i = 0; (i < count) && (result == 0); i++) {
+        struct i2c_msg &message = messages[i];
+        
+        // address byte plus data, each with its acknowledge
+        busTimeUs += this->messageTimeUs + ((message.len + 1) * this->byteTimeUs);
+        this->messageCount++;
+        this->bytes += message.len;
+        
+        std::shared_ptr<Vl6180Sim> target;
+        for (size_t s = 0; s < this->sensors.size(); s++) {
+            if (this->sensors[s]->getAddr() == message.addr) {
+                target = this->sensors[s];
+                break;
+            }
+        }
+        
+        if (!target) {
+            result = EREMOTEIO;
+        }
+        else if (message.flags & I2C_M_RD) {
+            result = target->read(message.buf, message.len) ? EREMOTEIO : 0;
+        }
+        else {
+            result = target->write(message.buf, message.len) ? EREMOTEIO : 0;
+        }
+    }
+    
+    // the bus stays busy for as long as the real transfer would take
+    std::this_thread::sleep_for(std::chrono::microseconds(busTimeUs));
+    
+    return result;
+}
+
+uint64_t Vl6180SimBus::getTransferCount() {
+    return this->transfers;
+}
+
+uint64_t Vl6180SimBus::getMessageCount() {
+    return this->messageCount;
+}
+
+uint64_t Vl6180SimBus::getByteCount() {
+    return this->bytes;
+}
@@ -0,0 +1,118 @@
+/**
+ * \file Vl6180Sim.h
+ *
+ *  Copyright (c) 2026 Agilatech. All rights reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __Vl6180Sim__
+#define __Vl6180Sim__
+
+#include <atomic>
+#include <errno.h>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "I2CTransport.h"
+#include "Vl6180Drv.h"
+
+#define VL6180_SIM_REGISTER_COUNT 0x0300
+
+/**
+ * @class Vl6180Sim
+ * @brief In-process model of a VL6180 register map
+ *
+ * Models the identification registers, single shot and continuous range and ALS measurements,
+ * interleaved mode, the range history buffer, configurable conversion times, the interrupt status
+ * and clear registers, and the result registers. Attach one or more sensors to a Vl6180SimBus and
+ * hand the bus to a Vl6180Drv in place of a dev file.
+ */
+class Vl6180Sim {
+    
+public:
+    Vl6180Sim(uint8_t addr = VL6180_DEFAULT_I2C_ADDR);
+    
+    uint8_t getAddr();
+    void setRange(uint8_t range, uint8_t error = VL6180_ERROR_NONE);
+    void setLux(float lux);
+    void setRangeConversionTime(uint32_t us);
+    void setAlsConversionTime(uint32_t us);
+    uint8_t peek(uint16_t reg);
+    
+    int write(const unsigned char *data, uint16_t length);
+    int read(unsigned char *data, uint16_t length);
+    
+protected:
+    typedef std::chrono::steady_clock Clock;
+    
+    void update();
+    void writeRegister(uint16_t reg, uint8_t value);
+    uint8_t readRegister(uint16_t reg);
+    void completeRange();
+    void completeAls();
+    uint32_t integrationMs();
+    uint32_t alsTimeUs();
+    uint8_t rangeEvent(uint8_t value);
+    uint8_t alsEvent(uint16_t value);
+    float alsGain();
+    
+    std::mutex lock;
+    uint8_t registers[VL6180_SIM_REGISTER_COUNT];
+    uint16_t pointer = 0;
+    
+    uint8_t range = 50;
+    uint8_t rangeError = VL6180_ERROR_NONE;
+    float lux = 100;
+    
+    // 0 for the ALS conversion time means follow the programmed integration period
+    uint32_t rangeConversionUs = 8000;
+    uint32_t alsConversionUs = 0;
+    
+    bool rangeBusy = false;
+    bool rangeContinuous = false;
+    bool alsBusy = false;
+    bool alsContinuous = false;
+    Clock::time_point rangeDue;
+    Clock::time_point alsDue;
+};
+
+/**
+ * @class Vl6180SimBus
+ * @brief I2C transport which routes messages to simulated sensors by address
+ *
+ * Every transfer occupies the bus for a fixed cost per message plus a cost per byte, which at the
+ * defaults approximates a 100 kHz bus. Messages to an address with no sensor fail as a NACK would.
+ */
+class Vl6180SimBus : public i2cbus::I2CTransport {
+    
+public:
+    Vl6180SimBus(uint32_t byteTimeUs = 90, uint32_t messageTimeUs = 20);
+    
+    void attach(std::shared_ptr<Vl6180Sim> sensor);
+    virtual int transfer(struct i2c_msg *messages, uint32_t count);
+    
+    uint64_t getTransferCount();
+    uint64_t getMessageCount();
+    uint64_t getByteCount();
+    
+protected:
+    std::mutex lock;
+    std::vector<std::shared_ptr<Vl6180Sim> > sensors;
+    
+    uint32_t byteTimeUs;
+    uint32_t messageTimeUs;
+    
+    std::atomic<uint64_t> transfers;
+    std::atomic<uint64_t> messageCount;
+    std::atomic<uint64_t> bytes;
+};
+
+#endif /* __Vl6180Sim__ */
@@ -0,0 +1,112 @@
+/**
+ * \file bench_format.cpp
+ *
+ *  Copyright (c) 2026 Agilatech. All rights reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <math.h>
+#include <string>
+#include "DataManip.h"
+
+// Checks DataManip number formatting against known text, then compares the cost of the
+// original dataToString with formatFixed and the current dataToString
+
+typedef std::chrono::steady_clock Clock;
+
+// dataToString(float, int) as it was before formatFixed
+static std::string originalDataToString(float data, int numDecimals) {
+    int whole = floor(data);
+    int large1 = round(data * pow(10, numDecimals));
+    int large2 = round(whole * pow(10, numDecimals));
+    int fraction = large1 - large2;
+    
+    return std::to_string(whole) + "." + std::to_string(fraction);
+}
+
+static int failures = 0;
+
+static void check(float data, int numDecimals, const std::string &expected) {
+    std::string text = DataManip::dataToString(data, numDecimals);
+    if (text != expected) {
+        std::cout << "FAIL dataToString(" << data << ", " << numDecimals << "): \"" << text
+                  << "\", expected \"" << expected << "\"" << std::endl;
+        failures++;
+    }
+}
+
+static void checkFormatting() {
+    check(1.05f, 2, "1.05");
+    check(-1.05f, 2, "-1.05");
+    check(-0.001f, 2, "0.00");
+    check(-0.001f, 3, "-0.001");
+    check(0.0f, 0, "0");
+    check(249.1f, 1, "249.1");
+    check(99.996f, 2, "100.00");
+    check(1e30f, 2, "1e+30");
+    check(3.4e38f, 1, "3.4e+38");
+    check(-3.4e38f, 1, "-3.4e+38");
+    check(std::numeric_limits<float>::infinity(), 2, "inf");
+    check(NAN, 2, "nan");
+    
+    // the longest fixed point text, just below where %g form takes over
+    if (DataManip::dataToString(-9.9e19f, DataManip::MAX_DECIMALS).empty()) {
+        std::cout << "FAIL dataToString(-9.9e19, " << DataManip::MAX_DECIMALS << ") did not fit" << std::endl;
+        failures++;
+    }
+    
+    char small[4];
+    if ((DataManip::formatFixed(123.45, 2, small, sizeof(small)) != 0) || (small[0] != '\0')) {
+        std::cout << "FAIL formatFixed into a short buffer did not leave it empty" << std::endl;
+        failures++;
+    }
+    
+    std::cout << "formatting checks: " << (failures ? "failed" : "passed") << std::endl;
+}
+
+// average ns per call of format over the same values at 2 decimals
+template <typename Format>
+static void benchFormat(const char *name, Format format, int calls) {
+    volatile size_t sink = 0;
+    Clock::time_point start = Clock::now();
+    
+    for (int i = 0; i < calls; i++) {
+        sink += format(i * 0.37f);
+    }
+    
+    double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    std::cout << name << ": " << ns / calls << " ns/value" << std::endl;
+}
+
+static size_t formatOriginal(float data) {
+    return originalDataToString(data, 2).size();
+}
+
+static size_t formatIntoBuffer(float data) {
+    char buffer[DataManip::FORMAT_BUFFER_SIZE];
+    return DataManip::formatFixed(data, 2, buffer, sizeof(buffer));
+}
+
+static size_t formatString(float data) {
+    return DataManip::dataToString(data, 2).size();
+}
+
+int main() {
+    checkFormatting();
+    
+    const int calls = 2000000;
+    benchFormat("original dataToString", formatOriginal, calls);
+    benchFormat("formatFixed", formatIntoBuffer, calls);
+    benchFormat("dataToString", formatString, calls);
+    
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,308 @@
+/**
+ * \file bench_range.cpp
+ *
+ *  Copyright (c) 2026 Agilatech. All rights reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "Vl6180Drv.h"
+#include "Vl6180Scheduler.h"
+#include "Vl6180Sim.h"
+
+// Measures single shot throughput, polling cost, multi-sensor scaling with and without the
+// scheduler, and request coalescing against simulated sensors on a simulated 100 kHz bus.
+// Also checks each continuous mode, failing the run when one collects the wrong samples.
+
+typedef std::chrono::steady_clock Clock;
+
+static int failures = 0;
+
+static double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count() / 1000.0;
+}
+
+// single shot reads of one index, reporting time and bus use per read
+static void benchSingleShot(int index, uint32_t conversionUs, int reads) {
+    std::shared_ptr<Vl6180SimBus> bus(new Vl6180SimBus());
+    std::shared_ptr<Vl6180Sim> sensor(new Vl6180Sim());
+    sensor->setRange(42);
+    sensor->setLux(250);
+    sensor->setRangeConversionTime(conversionUs);
+    bus->attach(sensor);
+    
+    Vl6180Drv driver(bus, VL6180_DEFAULT_I2C_ADDR);
+    
+    uint64_t transfers = bus->getTransferCount();
+    uint64_t bytes = bus->getByteCount();
+    Clock::time_point start = Clock::now();
+    
+    for (int i = 0; i < reads; i++) {
+        driver.getValueAtIndex(index);
+    }
+    
+    double ms = elapsedMs(start);
+    std::cout << "single shot index " << index << " (range conversion " << conversionUs << " us): "
+              << ms / reads << " ms/read, "
+              << (double)(bus->getTransferCount() - transfers) / reads << " transfers/read, "
+              << (double)(bus->getByteCount() - bytes) / reads << " bytes/read" << std::endl;
+}
+
+// ranges several sensors on one bus one after another, as callers did before any scheduler
+static void benchSequential(int count, uint32_t conversionUs, int sweeps) {
+    std::shared_ptr<Vl6180SimBus> bus(new Vl6180SimBus());
+    std::vector<std::unique_ptr<Vl6180Drv> > drivers;
+    
+    for (int i = 0; i < count; i++) {
+        std::shared_ptr<Vl6180Sim> sensor(new Vl6180Sim(0x30 + i));
+        sensor->setRange(10 + i);
+        sensor->setRangeConversionTime(conversionUs);
+        bus->attach(sensor);
+        drivers.emplace_back(new Vl6180Drv(bus, 0x30 + i));
+    }
+    
+    Clock::time_point start = Clock::now();
+    for (int s = 0; s < sweeps; s++) {
+        for (size_t i = 0; i < drivers.size(); i++) {
+            drivers[i]->getValueAtIndex(0);
+        }
+    }
+    
+    std::cout << "sequential, " << count << " sensors: " << elapsedMs(start) / sweeps << " ms/sweep" << std::endl;
+}
+
+// ranges the same sensors with their conversions overlapped by Vl6180Scheduler
+static void benchSweep(int count, uint32_t conversionUs, int sweeps) {
+    std::shared_ptr<Vl6180SimBus> bus(new Vl6180SimBus());
+    std::vector<std::unique_ptr<Vl6180Drv> > drivers;
+    Vl6180Scheduler scheduler;
+    
+    for (int i = 0; i < count; i++) {
+        std::shared_ptr<Vl6180Sim> sensor(new Vl6180Sim(0x30 + i));
+        sensor->setRange(10 + i);
+        sensor->setRangeConversionTime(conversionUs);
+        bus->attach(sensor);
+        drivers.emplace_back(new Vl6180Drv(bus, 0x30 + i));
+        scheduler.add(drivers.back().get());
+    }
+    
+    std::vector<RangeSample> samples;
+    size_t valid = 0;
+    
+    Clock::time_point start = Clock::now();
+    for (int s = 0; s < sweeps; s++) {
+        valid += scheduler.sweep(samples);
+    }
+    
+    std::cout << "scheduled sweep, " << count << " sensors: " << elapsedMs(start) / sweeps << " ms/sweep, "
+              << valid << "/" << count * sweeps << " valid" << std::endl;
+}
+
+// many threads asking for the same index at once, counting the conversions they cause
+static void benchCoalescing(int threads) {
+    std::shared_ptr<Vl6180SimBus> bus(new Vl6180SimBus());
+    std::shared_ptr<Vl6180Sim> sensor(new Vl6180Sim());
+    sensor->setRangeConversionTime(20000);
+    bus->attach(sensor);
+    
+    Vl6180Drv driver(bus, VL6180_DEFAULT_I2C_ADDR);
+    
+    uint64_t transfers = bus->getTransferCount();
+    driver.getValueAtIndex(0);
+    uint64_t perRead = bus->getTransferCount() - transfers;
+    
+    transfers = bus->getTransferCount();
+    Clock::time_point start = Clock::now();
+    
+    std::vector<std::thread> callers;
+    for (int i = 0; i < threads; i++) {
+        callers.emplace_back([&driver]() { driver.getValueAtIndex(0); });
+    }
+    for (size_t i = 0; i < callers.size(); i++) {
+        callers[i].join();
+    }
+    
+    std::cout << "coalescing, " << threads << " concurrent requests: " << elapsedMs(start) << " ms, "
+              << (double)(bus->getTransferCount() - transfers) / perRead << " conversions" << std::endl;
+}
+
+static void expect(bool ok, const char *what) {
+    if (!ok) {
+        std::cout << "FAIL " << what << std::endl;
+        failures++;
+    }
+}
+
+static void sleepMs(int ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+static bool closeTo(float value, float expected) {
+    return std::fabs(value - expected) <= expected * 0.02;
+}
+
+// continuous ranging of a steady target: every sample is that range
+static void checkContinuousRange(Vl6180Drv &driver, Vl6180Sim &sensor) {
+    RangeSample samples[VL6180_SAMPLE_BUFFER_SIZE];
+    
+    sensor.setRange(42);
+    expect(driver.startContinuousRange(), "continuous ranging did not start");
+    sleepMs(300);
+    driver.stopContinuous();
+    
+    size_t count = driver.drainRanges(samples, VL6180_SAMPLE_BUFFER_SIZE);
+    bool steady = true;
+    for (size_t i = 0; i < count; i++) {
+        steady = steady && samples[i].valid && (samples[i].range == 42);
+    }
+    expect(count >= 8, "continuous ranging collected too few samples");
+    expect(steady, "continuous ranging collected a wrong sample");
+    expect(driver.getMode() == VL6180_MODE_SINGLE_SHOT, "continuous ranging did not stop");
+}
+
+// interleaved mode: every pair holds both the range and the lux
+static void checkInterleaved(Vl6180Drv &driver, Vl6180Sim &sensor) {
+    InterleavedSample pairs[VL6180_SAMPLE_BUFFER_SIZE];
+    
+    sensor.setRange(42);
+    sensor.setLux(250);
+    expect(driver.startInterleaved(), "interleaved mode did not start");
+    sleepMs(300);
+    driver.stopContinuous();
+    
+    size_t count = driver.drainInterleaved(pairs, VL6180_SAMPLE_BUFFER_SIZE);
+    bool steady = true;
+    for (size_t i = 0; i < count; i++) {
+        steady = steady && pairs[i].rangeValid && (pairs[i].range == 42) && pairs[i].alsValid && closeTo(pairs[i].lux, 250);
+    }
+    expect(count >= 4, "interleaved mode collected too few pairs");
+    expect(steady, "interleaved mode collected a wrong pair");
+}
+
+// the history buffer while the target moves away: the ranges come out in order, and the
+// fetches neither repeat nor skip whole runs of them
+static void checkRangeHistory(Vl6180Drv &driver, Vl6180Sim &sensor) {
+    RangeSample samples[VL6180_SAMPLE_BUFFER_SIZE];
+    
+    sensor.setRange(10);
+    expect(driver.startRangeHistory(), "history mode did not start");
+    for (int range = 10; range < 50; range++) {
+        sensor.setRange(range);
+        sleepMs(20);
+    }
+    driver.stopContinuous();
+    
+    size_t count = driver.drainRanges(samples, VL6180_SAMPLE_BUFFER_SIZE);
+    bool ordered = true;
+    int distinct = 0;
+    for (size_t i = 0; i < count; i++) {
+        ordered = ordered && samples[i].valid && (samples[i].range < 50);
+        if ((i == 0) || (samples[i].range != samples[i - 1].range)) {
+            ordered = ordered && ((i == 0) || (samples[i].range > samples[i - 1].range));
+            distinct++;
+        }
+    }
+    expect(count >= 20, "history mode collected too few ranges");
+    expect(ordered, "history mode collected ranges out of order");
+    expect(distinct >= 20, "history mode repeated ranges instead of following the target");
+}
+
+// range events with the target moving out of the window: only the ranges outside it arrive
+static void checkRangeEvents(Vl6180Drv &driver, Vl6180Sim &sensor) {
+    ThresholdEvent events[VL6180_SAMPLE_BUFFER_SIZE];
+    
+    sensor.setRange(42);
+    expect(driver.startRangeEvents(VL6180_THRESHOLD_WINDOW, 30, 60), "range events did not start");
+    sleepMs(200);
+    sensor.setRange(80);
+    sleepMs(400);
+    driver.stopContinuous();
+    
+    size_t count = driver.drainEvents(events, VL6180_SAMPLE_BUFFER_SIZE);
+    bool outside = true;
+    for (size_t i = 0; i < count; i++) {
+        outside = outside && (events[i].code == VL6180_THRESHOLD_WINDOW) && (events[i].range == 80);
+    }
+    expect(count >= 1, "range events missed the target leaving the window");
+    expect(outside, "range events reported a range inside the window");
+}
+
+// ALS events with the light rising past the high threshold
+static void checkAlsEvents(Vl6180Drv &driver, Vl6180Sim &sensor) {
+    ThresholdEvent events[VL6180_SAMPLE_BUFFER_SIZE];
+    
+    sensor.setLux(250);
+    expect(driver.startAlsEvents(VL6180_THRESHOLD_HIGH, 0, 500), "ALS events did not start");
+    sleepMs(200);
+    sensor.setLux(1000);
+    sleepMs(800);
+    driver.stopContinuous();
+    
+    size_t count = driver.drainEvents(events, VL6180_SAMPLE_BUFFER_SIZE);
+    bool above = true;
+    for (size_t i = 0; i < count; i++) {
+        above = above && (events[i].code == VL6180_THRESHOLD_HIGH) && closeTo(events[i].lux, 1000);
+    }
+    expect(count >= 1, "ALS events missed the light rising");
+    expect(above, "ALS events reported light below the threshold");
+}
+
+// runs every continuous mode twice on one sensor, each starting straight after the last
+// stopped, then checks that single shot measurements work again
+static void checkContinuousModes() {
+    std::shared_ptr<Vl6180SimBus> bus(new Vl6180SimBus());
+    std::shared_ptr<Vl6180Sim> sensor(new Vl6180Sim());
+    sensor->setRangeConversionTime(8000);
+    bus->attach(sensor);
+    
+    Vl6180Drv driver(bus, VL6180_DEFAULT_I2C_ADDR);
+    
+    // 20ms ranging and 40ms ALS periods, with an integration period short enough to interleave
+    Vl6180Timing timing = { 12, 0x00, 0xFF, 0x7B, 0x01, 0x03 };
+    expect(driver.setTiming(timing), "timing was not accepted");
+    expect(driver.setAlsRange(VL6180_ALS_GAIN_1, 20), "ALS range was not accepted");
+    
+    for (int run = 0; run < 2; run++) {
+        checkContinuousRange(driver, *sensor);
+        checkInterleaved(driver, *sensor);
+        checkRangeHistory(driver, *sensor);
+        checkRangeEvents(driver, *sensor);
+        checkAlsEvents(driver, *sensor);
+    }
+    
+    sensor->setRange(42);
+    expect(driver.getValueAtIndex(0) == "42", "single shot ranging failed after the continuous modes");
+    
+    std::cout << "continuous mode checks: " << (failures ? "failed" : "passed") << std::endl;
+}
+
+int main() {
+    benchSingleShot(0, 8000, 50);
+    benchSingleShot(0, 20000, 20);
+    benchSingleShot(1, 8000, 10);
+    
+    for (int count = 1; count <= 8; count *= 2) {
+        benchSequential(count, 20000, 5);
+    }
+    for (int count = 1; count <= 8; count *= 2) {
+        benchSweep(count, 20000, 5);
+    }
+    
+    benchCoalescing(16);
+    
+    checkContinuousModes();
+    
+    return failures ? 1 : 0;
+}
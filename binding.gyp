@@ -2,7 +2,7 @@
     "targets": [
         {
             "target_name": "vl6180",
-            "sources": [ "DataManip.cpp", "Device.cpp", "I2CDevice.cpp", "Vl6180Drv.cpp", "Vl6180Node.cpp" ],
+            "sources": [ "DataManip.cpp", "Device.cpp", "I2CBus.cpp", "I2CExecutor.cpp", "I2CDevice.cpp", "GpioLine.cpp", "Vl6180Drv.cpp", "Vl6180Scheduler.cpp", "Vl6180Node.cpp" ],
             "cflags": ["-std=c++11", "-Wall"],
         }
     ]